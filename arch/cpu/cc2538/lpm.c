@@ -44,6 +44,10 @@
 #include "lpm.h"
 #include "cc2538_cm3.h"
 #include "reg.h"
+#if MAC_CONF_WITH_TSCH
+#include "net/mac/llsec802154.h"
+#include "net/mac/tsch/tsch-security.h"
+#endif /* MAC_CONF_WITH_TSCH */
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -216,6 +220,11 @@ lpm_exit()
     ENERGEST_SWITCH(ENERGEST_TYPE_LPM, ENERGEST_TYPE_CPU);
   } else {
     ENERGEST_SWITCH(ENERGEST_TYPE_DEEP_LPM, ENERGEST_TYPE_CPU);
+#if MAC_CONF_WITH_TSCH && LLSEC802154_ENABLED
+    /* The AES key store is not retained in PM2, TSCH has to load its key
+     * again before the next secured frame */
+    tsch_security_invalidate_key();
+#endif /* MAC_CONF_WITH_TSCH && LLSEC802154_ENABLED */
   }
 
   /* Restore PMCTL to PM0 for next pass */
@@ -132,6 +132,11 @@ typedef unsigned long clock_time_t;
 
 #define PLATFORM_CONF_SUPPORTS_STACK_CHECK  0
 
+/* Word-oriented AES, faster than the default software AES on the host */
+#ifndef AES_128_CONF
+#define AES_128_CONF aes_128_ttable_driver
+#endif /* AES_128_CONF */
+
 /*---------------------------------------------------------------------------*/
 /* Support for the new GPIO HAL */
 #define GPIO_HAL_CONF_ARCH_HDR_PATH      "dev/gpio-hal-arch.h"
@@ -43,6 +43,9 @@
 #include "net/ipv6/uip-sr.h"
 #include "net/mac/tsch/tsch.h"
 #include "net/routing/routing.h"
+#if BUILD_WITH_MSF
+#include "services/msf/msf.h"
+#endif /* BUILD_WITH_MSF */
 #include "rpl-conf.h" //  LF
 
 #define DEBUG DEBUG_PRINT
@@ -75,6 +78,9 @@ PROCESS_THREAD(node_process, ev, data)
     NETSTACK_ROUTING.root_start();
   }
   NETSTACK_MAC.on();
+#if BUILD_WITH_MSF
+  sixtop_add_sf(&msf_driver);
+#endif /* BUILD_WITH_MSF */
 
 #if WITH_PERIODIC_ROUTES_PRINT
   {
@@ -58,6 +58,12 @@
  * Larger values result in less frequent active slots: reduces capacity and saves energy. */
 #define TSCH_SCHEDULE_CONF_DEFAULT_LENGTH 3
 
+#if BUILD_WITH_MSF
+/* Let any packet to the parent use the cells negotiated by MSF */
+#define MSF_CONF_SLOTFRAME_HANDLE 5
+#define TSCH_CONF_LINK_SELECTOR_OPEN_SLOTFRAME MSF_CONF_SLOTFRAME_HANDLE
+#endif /* BUILD_WITH_MSF */
+
 #if WITH_SECURITY
 
 /* Enable security */
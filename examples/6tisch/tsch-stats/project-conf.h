@@ -73,6 +73,9 @@
 /* Enable periodic RSSI sampling for TSCH statistics */
 #define TSCH_STATS_CONF_SAMPLE_NOISE_RSSI 1
 
+/* Keep per-channel link quality statistics for every neighbor */
+#define TSCH_STATS_CONF_PER_NEIGHBOR 1
+
 /* Reduce the TSCH stat "decay to normal" period to get printouts more often */
 #define TSCH_STATS_CONF_DECAY_INTERVAL (60 * CLOCK_SECOND)
 
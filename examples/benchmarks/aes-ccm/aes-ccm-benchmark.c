@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Compares the software AES-128 drivers when running CCM* on a
+ *         fixed set of frames shaped like TSCH link-layer traffic.
+ */
+
+#include "contiki.h"
+#include "lib/aes-128.h"
+#include "lib/ccm-star.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* How many times the whole corpus is secured with each driver */
+#define ROUNDS 20000
+#define MIC_LEN 4
+
+PROCESS(aes_ccm_benchmark_process, "AES-CCM* benchmark");
+AUTOSTART_PROCESSES(&aes_ccm_benchmark_process);
+
+/* A frame: a_len bytes of authenticated header, m_len of encrypted payload */
+struct frame {
+  const char *name;
+  uint8_t a_len;
+  uint8_t m_len;
+};
+
+static const struct frame corpus[] = {
+  { "EACK", 17, 0 },
+  { "EB", 39, 0 },
+  { "keep-alive", 24, 0 },
+  { "UDP data", 24, 48 },
+  { "RPL DIO", 24, 76 },
+  { "max frame", 24, 95 },
+};
+#define CORPUS_SIZE (sizeof(corpus) / sizeof(corpus[0]))
+
+static const struct aes_128_driver *drivers[] = {
+  &aes_128_driver,
+  &aes_128_ttable_driver,
+};
+static const char *driver_names[] = {
+  "aes_128_driver",
+  "aes_128_ttable_driver",
+};
+#define DRIVER_COUNT (sizeof(drivers) / sizeof(drivers[0]))
+
+/* The driver CCM* is currently using */
+static const struct aes_128_driver *current_driver;
+
+/*---------------------------------------------------------------------------*/
+static void
+bench_set_key(const uint8_t *key)
+{
+  current_driver->set_key(key);
+}
+/*---------------------------------------------------------------------------*/
+static void
+bench_encrypt(uint8_t *plaintext_and_result)
+{
+  current_driver->encrypt(plaintext_and_result);
+}
+/*---------------------------------------------------------------------------*/
+const struct aes_128_driver bench_aes_128_driver = {
+  bench_set_key,
+  bench_encrypt
+};
+/*---------------------------------------------------------------------------*/
+/* Secure the frame corpus, return a checksum of all MICs */
+static uint32_t
+secure_corpus(void)
+{
+  static const uint8_t key[AES_128_KEY_LENGTH] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+    0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+  };
+  uint8_t nonce[CCM_STAR_NONCE_LENGTH];
+  uint8_t buf[128];
+  uint8_t mic[MIC_LEN];
+  uint32_t checksum = 0;
+  uint16_t i;
+  uint16_t j;
+
+  memset(nonce, 0xa5, sizeof(nonce));
+  for(i = 0; i < CORPUS_SIZE; i++) {
+    for(j = 0; j < corpus[i].a_len + corpus[i].m_len; j++) {
+      buf[j] = j;
+    }
+    nonce[CCM_STAR_NONCE_LENGTH - 1] = i;
+    CCM_STAR.set_key(key);
+    CCM_STAR.aead(nonce, buf + corpus[i].a_len, corpus[i].m_len,
+                  buf, corpus[i].a_len, mic, MIC_LEN, 1);
+    for(j = 0; j < MIC_LEN; j++) {
+      checksum = (checksum << 1) ^ (checksum >> 31) ^ mic[j];
+    }
+  }
+  return checksum;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(aes_ccm_benchmark_process, ev, data)
+{
+  static uint8_t d;
+  static uint32_t reference_checksum;
+  static uint8_t failed;
+  uint32_t checksum;
+  uint32_t r;
+  clock_time_t start;
+  unsigned long elapsed_ms;
+
+  PROCESS_BEGIN();
+
+  printf("CCM* over %u frames, %u rounds, MIC length %u\n",
+         (unsigned)CORPUS_SIZE, ROUNDS, MIC_LEN);
+
+  for(d = 0; d < DRIVER_COUNT; d++) {
+    current_driver = drivers[d];
+    checksum = 0;
+    start = clock_time();
+    for(r = 0; r < ROUNDS; r++) {
+      checksum = secure_corpus();
+    }
+    elapsed_ms = (unsigned long)(clock_time() - start) * 1000 / CLOCK_SECOND;
+    printf("%-22s %6lu ms, %4lu ns/frame, checksum %08lx\n",
+           driver_names[d], elapsed_ms,
+           elapsed_ms * 1000000 / ((unsigned long)ROUNDS * CORPUS_SIZE),
+           (unsigned long)checksum);
+    /* Every driver must produce the MICs of the reference driver */
+    if(d == 0) {
+      reference_checksum = checksum;
+    } else if(checksum != reference_checksum) {
+      printf("FAILED: %s checksum differs from %s\n",
+             driver_names[d], driver_names[0]);
+      failed = 1;
+    }
+    /* Let other processes run between drivers */
+    PROCESS_PAUSE();
+  }
+
+  printf(failed ? "FAILED\n" : "done\n");
+
+#ifdef CONTIKI_TARGET_NATIVE
+  /* Nothing else to run, give the shell back */
+  exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+#endif /* CONTIKI_TARGET_NATIVE */
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Measures how fast 6P packets carrying CellLists of growing length
+ *         are built in the packetbuf, parsed back, and decoded.
+ */
+
+#include "contiki.h"
+#include "net/packetbuf.h"
+#include "net/mac/tsch/sixtop/sixp-pkt.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* How many times each packet is built and parsed */
+#define ROUNDS 200000
+
+PROCESS(sixp_pkt_benchmark_process, "6P packet benchmark");
+AUTOSTART_PROCESSES(&sixp_pkt_benchmark_process);
+
+struct bench_case {
+  const char *name;
+  sixp_pkt_type_t type;
+  uint8_t code;
+  uint8_t num_cells;
+};
+
+/* The largest CellLists still fit in a single 802.15.4 frame */
+static const struct bench_case cases[] = {
+  { "ADD request, 1 cell", SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_ADD, 1 },
+  { "ADD request, 8 cells", SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_ADD, 8 },
+  { "ADD request, 28 cells", SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_ADD, 28 },
+  { "RELOCATE request, 2x14 cells",
+    SIXP_PKT_TYPE_REQUEST, SIXP_PKT_CMD_RELOCATE, 14 },
+  { "SUCCESS response, 28 cells",
+    SIXP_PKT_TYPE_RESPONSE, SIXP_PKT_RC_SUCCESS, 28 },
+};
+#define CASE_COUNT (sizeof(cases) / sizeof(cases[0]))
+
+/* The length of Metadata, CellOptions and NumCells in requests */
+#define REQ_HDR_LEN 4
+
+static uint8_t body[PACKETBUF_SIZE];
+static uint8_t cells[PACKETBUF_SIZE];
+
+/*---------------------------------------------------------------------------*/
+static uint32_t
+decode_cells(const uint8_t *cell_list, uint16_t cell_list_len)
+{
+  uint32_t checksum = 0;
+  uint16_t slot_offset;
+  uint16_t channel_offset;
+  uint16_t i;
+
+  for(i = 0; i < cell_list_len; i += SIXP_PKT_CELL_LEN) {
+    sixp_pkt_read_cell(&cell_list[i], &slot_offset, &channel_offset);
+    checksum = (checksum << 1) ^ (checksum >> 31) ^
+      ((uint32_t)slot_offset << 16) ^ channel_offset;
+  }
+  return checksum;
+}
+/*---------------------------------------------------------------------------*/
+/* Build a packet in the packetbuf, parse it, and return a checksum of its cells */
+static uint32_t
+build_and_parse(const struct bench_case *c, uint32_t round)
+{
+  sixp_pkt_code_t code = (sixp_pkt_code_t)c->code;
+  uint16_t cell_list_len = c->num_cells * SIXP_PKT_CELL_LEN;
+  uint16_t body_len;
+  uint8_t *cell_list;
+  const uint8_t *p;
+  sixp_pkt_offset_t len;
+  sixp_pkt_t pkt;
+  uint32_t checksum = 0;
+  uint16_t i;
+
+  if(c->code == SIXP_PKT_CMD_RELOCATE) {
+    /* RelCellList and CandCellList are copied in after NumCells */
+    for(i = 0; i < cell_list_len; i += SIXP_PKT_CELL_LEN) {
+      sixp_pkt_write_cell(&cells[i], (i + round) % 101, i & 0x0f);
+    }
+    body_len = REQ_HDR_LEN + 2 * cell_list_len;
+    if(sixp_pkt_set_cell_options(c->type, code, SIXP_PKT_CELL_OPTION_TX,
+                                 body, body_len) < 0 ||
+       sixp_pkt_set_num_cells(c->type, code, c->num_cells,
+                              body, body_len) < 0 ||
+       sixp_pkt_set_rel_cell_list(c->type, code, cells, cell_list_len, 0,
+                                  body, body_len) < 0 ||
+       sixp_pkt_set_cand_cell_list(c->type, code, cells, cell_list_len, 0,
+                                   body, body_len) < 0) {
+      return 0;
+    }
+  } else {
+    /* CellList is encoded in place */
+    body_len = (c->type == SIXP_PKT_TYPE_REQUEST ? REQ_HDR_LEN : 0) +
+      cell_list_len;
+    if((cell_list = sixp_pkt_get_cell_list_buf(c->type, code, cell_list_len,
+                                               body, body_len)) == NULL) {
+      return 0;
+    }
+    for(i = 0; i < cell_list_len; i += SIXP_PKT_CELL_LEN) {
+      sixp_pkt_write_cell(&cell_list[i], (i + round) % 101, i & 0x0f);
+    }
+    if(c->type == SIXP_PKT_TYPE_REQUEST &&
+       (sixp_pkt_set_cell_options(c->type, code, SIXP_PKT_CELL_OPTION_TX,
+                                  body, body_len) < 0 ||
+        sixp_pkt_set_num_cells(c->type, code, 1, body, body_len) < 0)) {
+      return 0;
+    }
+  }
+
+  if(sixp_pkt_create(c->type, code, 0, round & 0xff,
+                     body, body_len, NULL) < 0 ||
+     sixp_pkt_parse(packetbuf_hdrptr(), packetbuf_totlen(), &pkt) < 0) {
+    return 0;
+  }
+
+  if(c->code == SIXP_PKT_CMD_RELOCATE) {
+    if(sixp_pkt_get_rel_cell_list(pkt.type, pkt.code, &p, &len,
+                                  pkt.body, pkt.body_len) == 0) {
+      checksum ^= decode_cells(p, len);
+    }
+    if(sixp_pkt_get_cand_cell_list(pkt.type, pkt.code, &p, &len,
+                                   pkt.body, pkt.body_len) == 0) {
+      checksum ^= decode_cells(p, len) << 1;
+    }
+  } else if(sixp_pkt_get_cell_list(pkt.type, pkt.code, &p, &len,
+                                   pkt.body, pkt.body_len) == 0) {
+    checksum = decode_cells(p, len);
+  }
+  return checksum;
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(sixp_pkt_benchmark_process, ev, data)
+{
+  static uint8_t c;
+  uint32_t checksum;
+  uint32_t r;
+  clock_time_t start;
+  unsigned long elapsed_ms;
+
+  PROCESS_BEGIN();
+
+  printf("6P build and parse, %u rounds\n", ROUNDS);
+
+  for(c = 0; c < CASE_COUNT; c++) {
+    checksum = 0;
+    start = clock_time();
+    for(r = 0; r < ROUNDS; r++) {
+      checksum += build_and_parse(&cases[c], r);
+    }
+    elapsed_ms = (unsigned long)(clock_time() - start) * 1000 / CLOCK_SECOND;
+    printf("%-30s %6lu ms, %5lu ns/packet, checksum %08lx\n",
+           cases[c].name, elapsed_ms,
+           elapsed_ms * 1000000 / ROUNDS, (unsigned long)checksum);
+    /* Let other processes run between cases */
+    PROCESS_PAUSE();
+  }
+
+  printf("done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
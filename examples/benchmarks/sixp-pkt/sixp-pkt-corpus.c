@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Seed packets for the 6P packet fuzzer, one or more per command
+ *         and return code, plus a few malformed ones
+ */
+
+#include "sixp-pkt-corpus.h"
+
+/* Header octets: version and type, code, SFID, SeqNum */
+static const uint8_t add_req_1[] = {
+  0x00, 0x01, 0x00, 0x05,
+  0x00, 0x00, 0x01, 0x01,
+  0x0a, 0x00, 0x03, 0x00
+};
+static const uint8_t add_req_5[] = {
+  0x00, 0x01, 0x00, 0x06,
+  0x00, 0x00, 0x01, 0x02,
+  0x0a, 0x00, 0x03, 0x00, 0x11, 0x00, 0x01, 0x00,
+  0x1c, 0x00, 0x0f, 0x00, 0x2b, 0x00, 0x07, 0x00,
+  0x64, 0x00, 0x00, 0x00
+};
+static const uint8_t delete_req[] = {
+  0x00, 0x02, 0x00, 0x07,
+  0x00, 0x00, 0x01, 0x01,
+  0x0a, 0x00, 0x03, 0x00
+};
+static const uint8_t relocate_req[] = {
+  0x00, 0x03, 0x00, 0x08,
+  0x00, 0x00, 0x02, 0x02,
+  0x0a, 0x00, 0x03, 0x00, 0x11, 0x00, 0x01, 0x00,
+  0x1c, 0x00, 0x0f, 0x00, 0x2b, 0x00, 0x07, 0x00,
+  0x30, 0x00, 0x02, 0x00
+};
+static const uint8_t count_req[] = {
+  0x00, 0x04, 0x00, 0x09,
+  0x00, 0x00, 0x02
+};
+static const uint8_t list_req[] = {
+  0x00, 0x05, 0x00, 0x0a,
+  0x00, 0x00, 0x01, 0x00, 0x02, 0x00, 0x05, 0x00
+};
+static const uint8_t signal_req[] = {
+  0x00, 0x06, 0x00, 0x0b,
+  0x00, 0x00, 0xde, 0xad, 0xbe, 0xef
+};
+static const uint8_t clear_req[] = {
+  0x00, 0x07, 0x00, 0x0c,
+  0x00, 0x00
+};
+static const uint8_t success_res_cells[] = {
+  0x10, 0x00, 0x00, 0x05,
+  0x0a, 0x00, 0x03, 0x00, 0x11, 0x00, 0x01, 0x00
+};
+static const uint8_t success_res_count[] = {
+  0x10, 0x00, 0x00, 0x09,
+  0x03, 0x00
+};
+static const uint8_t success_res_empty[] = {
+  0x10, 0x00, 0x00, 0x0c
+};
+static const uint8_t eol_res[] = {
+  0x10, 0x01, 0x00, 0x0a,
+  0x0a, 0x00, 0x03, 0x00
+};
+static const uint8_t busy_res[] = {
+  0x10, 0x08, 0x00, 0x05
+};
+static const uint8_t success_conf[] = {
+  0x20, 0x00, 0x00, 0x08,
+  0x1c, 0x00, 0x0f, 0x00
+};
+static const uint8_t reserved_type[] = {
+  0x30, 0x00, 0x00, 0x01
+};
+static const uint8_t bad_version[] = {
+  0x01, 0x01, 0x00, 0x05,
+  0x00, 0x00, 0x01, 0x01,
+  0x0a, 0x00, 0x03, 0x00
+};
+static const uint8_t truncated_add_req[] = {
+  0x00, 0x01, 0x00, 0x05,
+  0x00, 0x00, 0x01, 0x01,
+  0x0a, 0x00
+};
+static const uint8_t short_relocate_req[] = {
+  0x00, 0x03, 0x00, 0x08,
+  0x00, 0x00, 0x02, 0x04,
+  0x0a, 0x00, 0x03, 0x00
+};
+
+#define SEED(name) { #name, name, sizeof(name) }
+
+const struct sixp_pkt_seed sixp_pkt_corpus[] = {
+  SEED(add_req_1),
+  SEED(add_req_5),
+  SEED(delete_req),
+  SEED(relocate_req),
+  SEED(count_req),
+  SEED(list_req),
+  SEED(signal_req),
+  SEED(clear_req),
+  SEED(success_res_cells),
+  SEED(success_res_count),
+  SEED(success_res_empty),
+  SEED(eol_res),
+  SEED(busy_res),
+  SEED(success_conf),
+  SEED(reserved_type),
+  SEED(bad_version),
+  SEED(truncated_add_req),
+  SEED(short_relocate_req),
+};
+const uint8_t sixp_pkt_corpus_size =
+  sizeof(sixp_pkt_corpus) / sizeof(sixp_pkt_corpus[0]);
@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Mutation fuzzer for the 6P packet parser and field getters, seeded
+ *         with sixp-pkt-corpus.c
+ */
+
+#include "contiki.h"
+#include "net/packetbuf.h"
+#include "net/mac/tsch/sixtop/sixp-pkt.h"
+#include "sixp-pkt-corpus.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* How many mutants are derived from each seed */
+#define MUTANTS_PER_SEED 200000
+/* The 6top IE content is 4 octets of header and "Other Fields" */
+#define SIXP_HDR_LEN 4
+
+PROCESS(sixp_pkt_fuzz_process, "6P packet fuzzer");
+AUTOSTART_PROCESSES(&sixp_pkt_fuzz_process);
+
+static uint8_t input[PACKETBUF_SIZE];
+static uint8_t payload[PACKETBUF_SIZE];
+static uint32_t prng_state = 0x6b8b4567;
+static unsigned long violations;
+
+/*---------------------------------------------------------------------------*/
+/* xorshift32: the same sequence on every run and every host */
+static uint32_t
+prng(void)
+{
+  prng_state ^= prng_state << 13;
+  prng_state ^= prng_state >> 17;
+  prng_state ^= prng_state << 5;
+  return prng_state;
+}
+/*---------------------------------------------------------------------------*/
+static uint16_t
+mutate(const struct sixp_pkt_seed *seed)
+{
+  uint16_t len = seed->len;
+  uint8_t n = 1 + prng() % 4;
+
+  memcpy(input, seed->data, len);
+  while(n--) {
+    switch(prng() % 6) {
+      case 0: /* flip a bit */
+        input[prng() % len] ^= 1 << (prng() % 8);
+        break;
+      case 1: /* overwrite a byte */
+        input[prng() % len] = prng();
+        break;
+      case 2: /* change the code, mostly to a defined one */
+        input[1] = prng() % 12;
+        break;
+      case 3: /* change the type */
+        input[0] = (input[0] & 0x0f) | ((prng() % 4) << 4);
+        break;
+      case 4: /* truncate */
+        len = prng() % (len + 1);
+        break;
+      default: /* append random octets */
+        while(len < sizeof(input) && (prng() % 8) != 0) {
+          input[len++] = prng();
+        }
+        break;
+    }
+    if(len == 0) {
+      break;
+    }
+  }
+  return len;
+}
+/*---------------------------------------------------------------------------*/
+static void
+check_range(const char *what, const sixp_pkt_t *pkt,
+            const uint8_t *p, uint16_t len)
+{
+  if(p < pkt->body || p + len > pkt->body + pkt->body_len ||
+     (len % SIXP_PKT_CELL_LEN) != 0) {
+    printf("violation: %s [type=%u, code=%u, body_len=%u]\n",
+           what, pkt->type, pkt->code.value, pkt->body_len);
+    violations++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Read every field the packet may have; none may come from outside its body */
+static void
+read_fields(const sixp_pkt_t *pkt)
+{
+  sixp_pkt_metadata_t metadata;
+  sixp_pkt_cell_options_t cell_options;
+  sixp_pkt_num_cells_t num_cells;
+  sixp_pkt_reserved_t reserved;
+  sixp_pkt_offset_t offset;
+  sixp_pkt_max_num_cells_t max_num_cells;
+  sixp_pkt_total_num_cells_t total_num_cells;
+  const uint8_t *p;
+  sixp_pkt_offset_t len;
+
+  sixp_pkt_get_metadata(pkt->type, pkt->code, &metadata,
+                        pkt->body, pkt->body_len);
+  sixp_pkt_get_cell_options(pkt->type, pkt->code, &cell_options,
+                            pkt->body, pkt->body_len);
+  sixp_pkt_get_num_cells(pkt->type, pkt->code, &num_cells,
+                         pkt->body, pkt->body_len);
+  sixp_pkt_get_reserved(pkt->type, pkt->code, &reserved,
+                        pkt->body, pkt->body_len);
+  sixp_pkt_get_offset(pkt->type, pkt->code, &offset,
+                      pkt->body, pkt->body_len);
+  sixp_pkt_get_max_num_cells(pkt->type, pkt->code, &max_num_cells,
+                             pkt->body, pkt->body_len);
+  sixp_pkt_get_total_num_cells(pkt->type, pkt->code, &total_num_cells,
+                               pkt->body, pkt->body_len);
+  sixp_pkt_get_payload(pkt->type, pkt->code, payload, sizeof(payload),
+                       pkt->body, pkt->body_len);
+
+  if(sixp_pkt_get_cell_list(pkt->type, pkt->code, &p, &len,
+                            pkt->body, pkt->body_len) == 0) {
+    check_range("CellList", pkt, p, len);
+  }
+  if(sixp_pkt_get_rel_cell_list(pkt->type, pkt->code, &p, &len,
+                                pkt->body, pkt->body_len) == 0) {
+    check_range("RelCellList", pkt, p, len);
+  }
+  if(sixp_pkt_get_cand_cell_list(pkt->type, pkt->code, &p, &len,
+                                 pkt->body, pkt->body_len) == 0) {
+    check_range("CandCellList", pkt, p, len);
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* An accepted packet must come out of sixp_pkt_create() unchanged */
+static void
+check_rebuild(const sixp_pkt_t *pkt, uint16_t len)
+{
+  const uint8_t *hdr;
+
+  if(sixp_pkt_create(pkt->type, pkt->code, pkt->sfid, pkt->seqno,
+                     pkt->body_len > 0 ? pkt->body : NULL, pkt->body_len,
+                     NULL) < 0) {
+    printf("violation: cannot rebuild [type=%u, code=%u, body_len=%u]\n",
+           pkt->type, pkt->code.value, pkt->body_len);
+    violations++;
+    return;
+  }
+
+  hdr = packetbuf_hdrptr();
+  /* The two most significant bits of the first octet are not parsed */
+  if(packetbuf_totlen() != len ||
+     hdr[0] != (input[0] & 0x3f) ||
+     memcmp(hdr + 1, input + 1, len - 1) != 0) {
+    printf("violation: rebuilt packet differs [type=%u, code=%u]\n",
+           pkt->type, pkt->code.value);
+    violations++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(sixp_pkt_fuzz_process, ev, data)
+{
+  static uint8_t s;
+  static unsigned long accepted;
+  sixp_pkt_t pkt;
+  uint32_t i;
+  uint16_t len;
+  uint16_t seed_accepted;
+
+  PROCESS_BEGIN();
+
+  printf("6P fuzzing, %u seeds, %u mutants per seed\n",
+         sixp_pkt_corpus_size, MUTANTS_PER_SEED);
+
+  for(s = 0; s < sixp_pkt_corpus_size; s++) {
+    /* The seed itself first */
+    memcpy(input, sixp_pkt_corpus[s].data, sixp_pkt_corpus[s].len);
+    seed_accepted = sixp_pkt_parse(input, sixp_pkt_corpus[s].len, &pkt) == 0;
+    if(seed_accepted) {
+      read_fields(&pkt);
+      check_rebuild(&pkt, sixp_pkt_corpus[s].len);
+    }
+
+    for(i = 0; i < MUTANTS_PER_SEED; i++) {
+      if((len = mutate(&sixp_pkt_corpus[s])) < SIXP_HDR_LEN) {
+        continue;
+      }
+      if(sixp_pkt_parse(input, len, &pkt) == 0) {
+        accepted++;
+        read_fields(&pkt);
+        check_rebuild(&pkt, len);
+      }
+    }
+    printf("%-20s %s\n", sixp_pkt_corpus[s].name,
+           seed_accepted ? "valid" : "rejected");
+    PROCESS_PAUSE();
+  }
+
+  printf("%lu mutants accepted, %lu violations\n", accepted, violations);
+  printf("done\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Measures the per-slot cost of computing the channel and the
+ *         slotframe timeslots from the ASN, with a full 40-bit modulo and
+ *         with the incremental modulo and channel table TSCH uses.
+ */
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch-asn.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* How many slots are walked with each method */
+#define SLOTS 2000000UL
+
+PROCESS(tsch_hopping_benchmark_process, "TSCH hopping benchmark");
+AUTOSTART_PROCESSES(&tsch_hopping_benchmark_process);
+
+/* TSCH_HOPPING_SEQUENCE_16_16 */
+static const uint8_t sequence[] = {
+  16, 17, 23, 18, 26, 15, 25, 22, 19, 11, 12, 13, 24, 14, 20, 21
+};
+#define SEQUENCE_LEN sizeof(sequence)
+static uint8_t channel_table[2 * SEQUENCE_LEN];
+
+/* Channel offsets in use, including Orchestra's hashed unicast offsets */
+static const uint16_t channel_offsets[] = { 0, 1, 2, 7, 15, 16, 129, 254 };
+#define OFFSET_COUNT (sizeof(channel_offsets) / sizeof(channel_offsets[0]))
+
+/* Orchestra's default slotframe sizes: EB, common, unicast */
+static const uint16_t slotframe_sizes[] = { 397, 31, 17 };
+#define SLOTFRAME_COUNT (sizeof(slotframe_sizes) / sizeof(slotframe_sizes[0]))
+
+static struct tsch_asn_divisor_t sequence_div;
+static struct tsch_asn_divisor_t slotframe_divs[SLOTFRAME_COUNT];
+static struct tsch_asn_mod_cache_t sequence_cache;
+static struct tsch_asn_mod_cache_t slotframe_caches[SLOTFRAME_COUNT];
+
+/*---------------------------------------------------------------------------*/
+/* How many slots to advance: idle slots are skipped now and then */
+static uint16_t
+next_step(uint32_t i)
+{
+  return (i & 0x3f) == 0 ? 1 + (i >> 6) % 400 : 1;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+run_full_modulo(void)
+{
+  struct tsch_asn_t asn;
+  uint32_t checksum = 0;
+  uint32_t i;
+  uint8_t j;
+
+  TSCH_ASN_INIT(asn, 0, 0xffffffff - SLOTS);
+  for(i = 0; i < SLOTS; i++) {
+    uint16_t index_of_0 = TSCH_ASN_MOD(asn, sequence_div);
+    uint16_t offset = channel_offsets[i % OFFSET_COUNT];
+    checksum += sequence[(index_of_0 + offset) % sequence_div.val];
+    for(j = 0; j < SLOTFRAME_COUNT; j++) {
+      checksum += TSCH_ASN_MOD(asn, slotframe_divs[j]);
+    }
+    TSCH_ASN_INC(asn, next_step(i));
+  }
+  return checksum;
+}
+/*---------------------------------------------------------------------------*/
+static uint32_t
+run_incremental(void)
+{
+  struct tsch_asn_t asn;
+  uint32_t checksum = 0;
+  uint32_t i;
+  uint8_t j;
+
+  TSCH_ASN_INIT(asn, 0, 0xffffffff - SLOTS);
+  for(i = 0; i < SLOTS; i++) {
+    uint16_t index_of_0 = tsch_asn_mod_incremental(&asn, &sequence_div, &sequence_cache);
+    uint16_t offset = channel_offsets[i % OFFSET_COUNT];
+    if(offset >= sequence_div.val) {
+      offset %= sequence_div.val;
+    }
+    checksum += channel_table[index_of_0 + offset];
+    for(j = 0; j < SLOTFRAME_COUNT; j++) {
+      checksum += tsch_asn_mod_incremental(&asn, &slotframe_divs[j], &slotframe_caches[j]);
+    }
+    TSCH_ASN_INC(asn, next_step(i));
+  }
+  return checksum;
+}
+/*---------------------------------------------------------------------------*/
+static void
+report(const char *name, uint32_t checksum, clock_time_t start)
+{
+  unsigned long elapsed_ms = (unsigned long)(clock_time() - start) * 1000 / CLOCK_SECOND;
+  printf("%-12s %6lu ms, %4lu ns/slot, checksum %08lx\n",
+         name, elapsed_ms, elapsed_ms * 1000000 / SLOTS,
+         (unsigned long)checksum);
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(tsch_hopping_benchmark_process, ev, data)
+{
+  clock_time_t start;
+  uint32_t checksum;
+  uint8_t j;
+
+  PROCESS_BEGIN();
+
+  TSCH_ASN_DIVISOR_INIT(sequence_div, SEQUENCE_LEN);
+  memcpy(channel_table, sequence, SEQUENCE_LEN);
+  memcpy(channel_table + SEQUENCE_LEN, sequence, SEQUENCE_LEN);
+  TSCH_ASN_MOD_CACHE_INIT(sequence_cache);
+  for(j = 0; j < SLOTFRAME_COUNT; j++) {
+    TSCH_ASN_DIVISOR_INIT(slotframe_divs[j], slotframe_sizes[j]);
+    TSCH_ASN_MOD_CACHE_INIT(slotframe_caches[j]);
+  }
+
+  printf("%lu slots, %u slotframes, hopping sequence length %u\n",
+         SLOTS, (unsigned)SLOTFRAME_COUNT, (unsigned)SEQUENCE_LEN);
+
+  start = clock_time();
+  checksum = run_full_modulo();
+  report("full modulo", checksum, start);
+  PROCESS_PAUSE();
+
+  start = clock_time();
+  checksum = run_incremental();
+  report("incremental", checksum, start);
+
+  printf("done\n");
+
+#ifdef CONTIKI_TARGET_NATIVE
+  /* Nothing else to run, give the shell back */
+  exit(0);
+#endif /* CONTIKI_TARGET_NATIVE */
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/
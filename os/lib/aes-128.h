@@ -69,4 +69,12 @@ struct aes_128_driver {
 
 extern const struct aes_128_driver AES_128;
 
+/**
+ * Software implementations. aes_128_ttable_driver works on 32-bit words
+ * with a 1 KB lookup table: faster than aes_128_driver on 32-bit hosts,
+ * but larger.
+ */
+extern const struct aes_128_driver aes_128_driver;
+extern const struct aes_128_driver aes_128_ttable_driver;
+
 #endif /* AES_128_H_ */
@@ -73,6 +73,8 @@
 #include "net/netstack.h"
 #include "net/packetbuf.h"
 #include "net/queuebuf.h"
+#include "lib/list.h"
+#include "lib/memb.h"
 
 #include "net/routing/routing.h"
 
@@ -195,6 +197,10 @@ static int last_tx_status;
 
 static int last_rssi;
 
+#if UIP_STATISTICS
+struct sicslowpan_hc_stats sicslowpan_hc_stats;
+#endif /* UIP_STATISTICS */
+
 /* ----------------------------------------------------------------- */
 /* Support for reassembling multiple packets                         */
 /* ----------------------------------------------------------------- */
@@ -239,6 +245,22 @@ static uint16_t my_tag;
 /* Assuming that the worst growth for uncompression is 38 bytes */
 #define SICSLOWPAN_FIRST_FRAGMENT_SIZE (SICSLOWPAN_FRAGMENT_SIZE + 38)
 
+/* The coverage of a datagram is tracked in units of 8 bytes, the
+ * granularity of fragment offsets */
+#define REASS_COVERAGE_UNITS ((UIP_BUFSIZE + 7) / 8)
+
+/* A FRAGN payload, allocated from a pool shared by all reassemblies */
+struct sicslowpan_frag_buf {
+  struct sicslowpan_frag_buf *next;
+  /* Fragment offset */
+  uint8_t offset;
+  /* Length of this fragment */
+  uint8_t len;
+  uint8_t data[SICSLOWPAN_FRAGMENT_SIZE];
+};
+
+MEMB(frag_buf_memb, struct sicslowpan_frag_buf, SICSLOWPAN_FRAGMENT_BUFFERS);
+
 /* all information needed for reassembly */
 struct sicslowpan_frag_info {
   /** When reassembling, the source address of the fragments being merged */
@@ -247,14 +269,22 @@ struct sicslowpan_frag_info {
   linkaddr_t receiver;
   /** When reassembling, the tag in the fragments being merged. */
   uint16_t tag;
-  /** Total length of the fragmented packet */
+  /** Total length of the fragmented packet, zero if the context is free */
   uint16_t len;
-  /** Current length of reassembled fragments */
-  uint16_t reassembled_len;
+  /** Set once the packet is reassembled. The context is then kept until
+   it times out, to recognize retransmitted fragments. */
+  uint8_t complete;
+  /** Bitmap of the 8-byte units of the packet received so far */
+  uint8_t coverage[(REASS_COVERAGE_UNITS + 7) / 8];
   /** Reassembly %process %timer. */
   struct timer reass_timer;
+  /** Rank of the last fragment among all fragments received, the least
+   recently active context is evicted first */
+  uint16_t last_activity;
+  /** The FRAGN payloads received so far */
+  LIST_STRUCT(frags);
 
-  /** Fragment size of first fragment */
+  /** Fragment size of first fragment, zero until it is received */
   uint16_t first_frag_len;
   /** First fragment - needs a larger buffer since the size is uncompressed size
    and we need to know total size to know when we have received last fragment. */
@@ -262,149 +292,330 @@ struct sicslowpan_frag_info {
 };
 
 static struct sicslowpan_frag_info frag_info[SICSLOWPAN_REASS_CONTEXTS];
+/* Incremented with every fragment received. Unlike the clock, it orders
+   fragments that arrive within the same tick. */
+static uint16_t frag_activity;
+
+/* Fragment forwarding (RFC 8930): instead of reassembling packets that
+ * are only relayed, the first fragment is routed on its own and installs
+ * a virtual reassembly buffer (VRB) entry. The subsequent fragments are
+ * forwarded as they arrive, with the tag and offset of the next hop. */
+#ifdef SICSLOWPAN_CONF_FRAG_FORWARDING
+#define SICSLOWPAN_FRAG_FORWARDING SICSLOWPAN_CONF_FRAG_FORWARDING
+#else
+#define SICSLOWPAN_FRAG_FORWARDING 0
+#endif
 
-struct sicslowpan_frag_buf {
-  /* the index of the frag_info */
-  uint8_t index;
-  /* Fragment offset */
-  uint8_t offset;
-  /* Length of this fragment (if zero this buffer is not allocated) */
-  uint8_t len;
-  uint8_t data[SICSLOWPAN_FRAGMENT_SIZE];
+#if SICSLOWPAN_FRAG_FORWARDING
+/* A packet queued while resolving the next hop would be sent later with
+   only its first fragment */
+#if UIP_CONF_IPV6_QUEUE_PKT && UIP_ND6_SEND_NS
+#error SICSLOWPAN_CONF_FRAG_FORWARDING requires UIP_CONF_IPV6_QUEUE_PKT or UIP_CONF_ND6_SEND_NS to be disabled
+#endif
+
+/* Number of packets that can be forwarded fragment by fragment at once */
+#ifdef SICSLOWPAN_CONF_VRB_ENTRIES
+#define SICSLOWPAN_VRB_ENTRIES SICSLOWPAN_CONF_VRB_ENTRIES
+#else
+#define SICSLOWPAN_VRB_ENTRIES 4
+#endif
+
+struct sicslowpan_vrb {
+  /** The previous hop and its tag for the packet */
+  linkaddr_t sender;
+  uint16_t tag;
+  /** Size of the packet as received, zero if the entry is free */
+  uint16_t size;
+  /** The next hop, linkaddr_null if the fragments are to be discarded */
+  linkaddr_t next_hop;
+  /** Tag and size of the packet towards the next hop */
+  uint16_t out_tag;
+  uint16_t out_size;
+  /** Change in header length introduced by the IP layer, in bytes */
+  int16_t offset_delta;
+  /** Bytes of the packet forwarded so far, each counted once. Once the
+   whole packet is forwarded, the entry is kept to recognize
+   retransmissions but can be reused for another packet. */
+  uint16_t forwarded;
+  /** Bitmap of the 8-byte units of the packet handled so far */
+  uint8_t coverage[(REASS_COVERAGE_UNITS + 7) / 8];
+  uint8_t max_mac_transmissions;
+#if LLSEC802154_USES_AUX_HEADER
+  uint8_t llsec_level;
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  uint8_t llsec_key_id;
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+  /** Expires when no fragment was forwarded for SICSLOWPAN_REASS_MAXAGE */
+  struct timer timer;
 };
 
-static struct sicslowpan_frag_buf frag_buf[SICSLOWPAN_FRAGMENT_BUFFERS];
+static struct sicslowpan_vrb vrb_table[SICSLOWPAN_VRB_ENTRIES];
+
+/* The entry of the first fragment handed to the IP layer, and how much of
+   the packet was actually received with it */
+static struct sicslowpan_vrb *vrb_pending;
+static uint16_t vrb_pending_len;
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 
 /*---------------------------------------------------------------------------*/
 static int
 clear_fragments(uint8_t frag_info_index)
 {
-  int i, clear_count;
+  struct sicslowpan_frag_buf *buf;
+  int clear_count;
   clear_count = 0;
   frag_info[frag_info_index].len = 0;
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len > 0 && frag_buf[i].index == frag_info_index) {
-      /* deallocate the buffer */
-      frag_buf[i].len = 0;
-      clear_count++;
-    }
+  while((buf = list_pop(frag_info[frag_info_index].frags)) != NULL) {
+    /* deallocate the buffer */
+    memb_free(&frag_buf_memb, buf);
+    clear_count++;
   }
   return clear_count;
 }
 /*---------------------------------------------------------------------------*/
-static int
-timeout_fragments(int not_context)
+static void
+timeout_fragments(void)
 {
   int i;
-  int count = 0;
   for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-    if(frag_info[i].len > 0 && i != not_context &&
-       timer_expired(&frag_info[i].reass_timer)) {
+    if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
       /* This context can be freed */
-      count += clear_fragments(i);
+      if(!frag_info[i].complete) {
+        LOG_WARN("reassembly: timeout for tag %d\n", frag_info[i].tag);
+        UIP_STAT(++uip_stat.reass.timeout);
+      }
+      clear_fragments(i);
     }
   }
-  return count;
 }
 /*---------------------------------------------------------------------------*/
+/* Free a context other than not_context: a completed one if any, else the
+   least recently active one. Unless with_first is set, i.e. the context
+   that needs room holds the first fragment of its packet, only contexts
+   still waiting for their first fragment can be evicted: a run of stray
+   FRAGNs must not cancel the reassemblies in progress. Return 0 if no
+   context can be freed. */
 static int
-store_fragment(uint8_t index, uint8_t offset)
+evict_fragments(int not_context, int with_first)
 {
   int i;
+  int lru = -1;
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    if(frag_info[i].len > 0 && i != not_context) {
+      if(frag_info[i].complete) {
+        clear_fragments(i);
+        return 1;
+      }
+      if(!with_first && frag_info[i].first_frag_len > 0) {
+        continue;
+      }
+      if(lru < 0 ||
+         (uint16_t)(frag_activity - frag_info[i].last_activity) >
+         (uint16_t)(frag_activity - frag_info[lru].last_activity)) {
+        lru = i;
+      }
+    }
+  }
+  if(lru < 0) {
+    return 0;
+  }
+  LOG_WARN("reassembly: evicting tag %d to make room\n", frag_info[lru].tag);
+  UIP_STAT(++uip_stat.reass.evicted);
+  clear_fragments(lru);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* The coverage units spanned by len bytes at a given offset. A unit that
+   is only partly covered counts only at the end of the packet. */
+static void
+coverage_range(uint16_t size, uint16_t offset, uint16_t len,
+               uint16_t *from, uint16_t *to)
+{
+  *from = offset >> 3;
+  *to = offset + len >= size ? (size + 7) >> 3 : (offset + len) >> 3;
+}
+/*---------------------------------------------------------------------------*/
+/* Mark units [from, to) as received, and return how many of them were
+   not received before */
+static uint16_t
+coverage_update(uint8_t *coverage, uint16_t from, uint16_t to)
+{
+  uint16_t added = 0;
+  for(; from < to; from++) {
+    if(!(coverage[from >> 3] & (1 << (from & 7)))) {
+      coverage[from >> 3] |= 1 << (from & 7);
+      added++;
+    }
+  }
+  return added;
+}
+/*---------------------------------------------------------------------------*/
+static int
+reassembly_complete(const struct sicslowpan_frag_info *info)
+{
+  uint16_t units = (info->len + 7) >> 3;
+  uint16_t i;
+
+  if(info->first_frag_len == 0) {
+    return 0;
+  }
+  for(i = 0; i < (units >> 3); i++) {
+    if(info->coverage[i] != 0xff) {
+      return 0;
+    }
+  }
+  return (units & 7) == 0
+    || (info->coverage[i] & ((1 << (units & 7)) - 1)) == (1 << (units & 7)) - 1;
+}
+/*---------------------------------------------------------------------------*/
+static int
+store_fragment(uint8_t index, uint8_t offset)
+{
+  struct sicslowpan_frag_info *info = &frag_info[index];
+  struct sicslowpan_frag_buf *buf;
+  uint16_t from, to;
   int len;
 
   len = packetbuf_datalen() - packetbuf_hdr_len;
 
-  if(len <= 0 || len > SICSLOWPAN_FRAGMENT_SIZE) {
+  if(len <= 0 || len > SICSLOWPAN_FRAGMENT_SIZE ||
+     (offset << 3) + len > info->len) {
     /* Unacceptable fragment size. */
     return -1;
   }
 
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
-    if(frag_buf[i].len == 0) {
-      /* copy over the data from packetbuf into the fragment buffer,
-         and store offset and len */
-      frag_buf[i].offset = offset; /* frag offset */
-      frag_buf[i].len = len;
-      frag_buf[i].index = index;
-      memcpy(frag_buf[i].data, packetbuf_ptr + packetbuf_hdr_len, len);
-      /* return the length of the stored fragment */
-      return len;
-    }
+  coverage_range(info->len, offset << 3, len, &from, &to);
+  if(coverage_update(info->coverage, from, to) == 0) {
+    /* Retransmitted fragment, we already have it */
+    UIP_STAT(++uip_stat.reass.dup);
+    return 0;
+  }
+
+  buf = memb_alloc(&frag_buf_memb);
+  while(buf == NULL && evict_fragments(index, info->first_frag_len > 0)) {
+    buf = memb_alloc(&frag_buf_memb);
+  }
+  if(buf == NULL) {
+    /* failed, and the coverage now lies about this fragment */
+    clear_fragments(index);
+    return -1;
   }
-  /* failed */
-  return -1;
+
+  /* copy over the data from packetbuf into the fragment buffer,
+     and store offset and len */
+  buf->offset = offset; /* frag offset */
+  buf->len = len;
+  memcpy(buf->data, packetbuf_ptr + packetbuf_hdr_len, len);
+  list_add(info->frags, buf);
+  /* return the length of the stored fragment */
+  return len;
 }
 /*---------------------------------------------------------------------------*/
-/* add a new fragment to the buffer */
+/* add a new fragment to the buffer. Returns the reassembly context, -1 on
+   failure, or -2 if the packet was already reassembled */
 static int8_t
 add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
 {
   int i;
-  int len;
   int8_t found = -1;
 
-  if(offset == 0) {
-    /* This is a first fragment - check if we can add this */
-    for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-      /* clear all fragment info with expired timer to free all fragment buffers */
-      if(frag_info[i].len > 0 && timer_expired(&frag_info[i].reass_timer)) {
-        clear_fragments(i);
-      }
+  /* clear all fragment info with expired timer to free all fragment buffers */
+  timeout_fragments();
 
+  /* Fragments may come in any order, whichever comes first opens the
+     context */
+  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+    if(frag_info[i].len > 0 && frag_info[i].tag == tag &&
+       linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+      /* Tag and Sender match - this must be the correct info to store in */
+      found = i;
+      break;
+    }
+  }
+
+  if(found >= 0 && frag_info[found].len != frag_size) {
+    /* The sender has reused the tag for a new packet */
+    clear_fragments(found);
+    found = -1;
+  }
+
+  if(found >= 0 && frag_info[found].complete) {
+    /* Retransmitted fragment of a packet we already reassembled */
+    LOG_DBG("reassembly: late duplicate - tag: %d offset: %d\n", tag, offset);
+    UIP_STAT(++uip_stat.reass.dup);
+    return -2;
+  }
+
+  if(found < 0) {
+    if(frag_size > UIP_BUFSIZE) {
+      LOG_WARN("reassembly: packet too large - tag: %d, len: %d\n", tag, frag_size);
+      UIP_STAT(++uip_stat.reass.drop);
+      return -1;
+    }
+
+    for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
       /* We use len as indication on used or not used */
-      if(found < 0 && frag_info[i].len == 0) {
-        /* We remember the first free fragment info but must continue
-           the loop to free any other expired fragment buffers. */
+      if(frag_info[i].len == 0) {
         found = i;
+        break;
+      }
+    }
+
+    if(found < 0 && evict_fragments(-1, offset == 0)) {
+      for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
+        if(frag_info[i].len == 0) {
+          found = i;
+          break;
+        }
       }
     }
 
     if(found < 0) {
-      LOG_WARN("reassembly: failed to store new fragment session - tag: %d\n", tag);
+      LOG_WARN("reassembly: no context free for tag %d\n", tag);
+      UIP_STAT(++uip_stat.reass.drop);
       return -1;
     }
 
     /* Found a free fragment info to store data in */
     frag_info[found].len = frag_size;
+    frag_info[found].complete = 0;
     frag_info[found].tag = tag;
+    frag_info[found].first_frag_len = 0;
+    memset(frag_info[found].coverage, 0, sizeof(frag_info[found].coverage));
+    LIST_STRUCT_INIT(&frag_info[found], frags);
     linkaddr_copy(&frag_info[found].sender,
                   packetbuf_addr(PACKETBUF_ADDR_SENDER));
     timer_set(&frag_info[found].reass_timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+  }
+
+  frag_info[found].last_activity = ++frag_activity;
+
+  if(offset == 0) {
     /* first fragment can not be stored immediately but is moved into
        the buffer while uncompressing */
     return found;
   }
 
-  /* This is a N-fragment - should find the info */
-  for(i = 0; i < SICSLOWPAN_REASS_CONTEXTS; i++) {
-    if(frag_info[i].tag == tag && frag_info[i].len > 0 &&
-       linkaddr_cmp(&frag_info[i].sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
-      /* Tag and Sender match - this must be the correct info to store in */
-      found = i;
-      break;
-    }
-  }
-
-  if(found < 0) {
-    /* no entry found for storing the new fragment */
-    LOG_WARN("reassembly: failed to store N-fragment - could not find session - tag: %d offset: %d\n", tag, offset);
+  if(store_fragment(found, offset) < 0) {
+    LOG_WARN("reassembly: failed to store fragment - packet reassembly will fail tag:%d\n", tag);
+    UIP_STAT(++uip_stat.reass.drop);
     return -1;
   }
+  return found;
+}
+/*---------------------------------------------------------------------------*/
+/* Account for the first fragment, once uncompressed into the context */
+static void
+add_first_fragment(uint8_t context, uint16_t len)
+{
+  struct sicslowpan_frag_info *info = &frag_info[context];
+  uint16_t from, to;
 
-  /* i is the index of the reassembly context */
-  len = store_fragment(i, offset);
-  if(len < 0 && timeout_fragments(i) > 0) {
-    len = store_fragment(i, offset);
-  }
-  if(len > 0) {
-    frag_info[i].reassembled_len += len;
-    return i;
-  } else {
-    /* should we also clear all fragments since we failed to store
-       this fragment? */
-    LOG_WARN("reassembly: failed to store fragment - packet reassembly will fail tag:%d l\n", frag_info[i].tag);
-    return -1;
+  info->first_frag_len = len;
+  coverage_range(info->len, 0, len, &from, &to);
+  if(coverage_update(info->coverage, from, to) == 0) {
+    UIP_STAT(++uip_stat.reass.dup);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -413,7 +624,8 @@ add_fragment(uint16_t tag, uint16_t frag_size, uint8_t offset)
 static bool
 copy_frags2uip(int context)
 {
-  int i;
+  struct sicslowpan_frag_buf *buf;
+  uint16_t len = frag_info[context].len;
 
   /* Check length fields before proceeding. */
   if(frag_info[context].len < frag_info[context].first_frag_len ||
@@ -431,20 +643,22 @@ copy_frags2uip(int context)
   memset((uint8_t *)UIP_IP_BUF + frag_info[context].first_frag_len, 0,
          frag_info[context].len - frag_info[context].first_frag_len);
 
-  for(i = 0; i < SICSLOWPAN_FRAGMENT_BUFFERS; i++) {
+  for(buf = list_head(frag_info[context].frags); buf != NULL; buf = list_item_next(buf)) {
     /* And also copy all matching fragments */
-    if(frag_buf[i].len > 0 && frag_buf[i].index == context) {
-      if((frag_buf[i].offset << 3) + frag_buf[i].len > sizeof(uip_buf)) {
-        LOG_WARN("input: invalid fragment offset\n");
-        clear_fragments(context);
-        return false;
-      }
-      memcpy((uint8_t *)UIP_IP_BUF + (uint16_t)(frag_buf[i].offset << 3),
-             (uint8_t *)frag_buf[i].data, frag_buf[i].len);
+    if((buf->offset << 3) + buf->len > sizeof(uip_buf)) {
+      LOG_WARN("input: invalid fragment offset\n");
+      clear_fragments(context);
+      return false;
     }
+    memcpy((uint8_t *)UIP_IP_BUF + (uint16_t)(buf->offset << 3),
+           (uint8_t *)buf->data, buf->len);
   }
-  /* deallocate all the fragments for this context */
+  /* deallocate all the fragments for this context, but keep it to
+     recognize retransmissions */
   clear_fragments(context);
+  frag_info[context].len = len;
+  frag_info[context].complete = 1;
+  UIP_STAT(++uip_stat.reass.complete);
 
   return true;
 }
@@ -498,6 +712,24 @@ set_packet_attrs(void)
 /*   } */
 
 }
+/*--------------------------------------------------------------------*/
+/* Keep the link-layer security of the received frame with the packet */
+static void
+set_llsec_attrs(void)
+{
+#if LLSEC802154_USES_AUX_HEADER
+  /*
+   * Assuming that the last packet in packetbuf is containing
+   *  the LLSEC state so that it can be copied to uipbuf.
+   */
+  uipbuf_set_attr(UIPBUF_ATTR_LLSEC_LEVEL,
+    packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL));
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  uipbuf_set_attr(UIPBUF_ATTR_LLSEC_KEY_ID,
+    packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX));
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /*  LLSEC802154_USES_AUX_HEADER */
+}
 
 
 
@@ -574,12 +806,10 @@ addr_context_lookup_by_number(uint8_t number)
 {
 /* Remove code to avoid warnings and save flash if no context is used */
 #if SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
-  int i;
-  for(i = 0; i < SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS; i++) {
-    if((addr_contexts[i].used == 1) &&
-       addr_contexts[i].number == number) {
-      return &addr_contexts[i];
-    }
+  /* Contexts are stored at the index of their number */
+  if(number < SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS &&
+     addr_contexts[number].used == 1) {
+    return &addr_contexts[number];
   }
 #endif /* SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
   return NULL;
@@ -1574,26 +1804,25 @@ send_packet(linkaddr_t *dest)
  */
 static int
 fragment_copy_payload_and_send(uint16_t uip_offset, linkaddr_t *dest) {
-  struct queuebuf *q;
+  /* Attributes of the datagram, kept across fragments */
+  static struct packetbuf_attr frag_attrs[PACKETBUF_NUM_ATTRS];
+  static struct packetbuf_addr frag_addrs[PACKETBUF_NUM_ADDRS];
 
   /* Now copy fragment payload from uip_buf */
   memcpy(packetbuf_ptr + packetbuf_hdr_len,
          (uint8_t *)UIP_IP_BUF + uip_offset, packetbuf_payload_len);
   packetbuf_set_datalen(packetbuf_payload_len + packetbuf_hdr_len);
 
-  /* Backup packetbuf to queuebuf. Enables preserving attributes for all framgnets */
-  q = queuebuf_new_from_packetbuf();
-  if(q == NULL) {
-    LOG_WARN("output: could not allocate queuebuf, dropping fragment\n");
-    return 0;
-  }
+  /* The MAC layer may update attributes and frame the packet in place.
+   * Only the attributes need restoring: the next fragment is built anew
+   * from its FRAGN header and uip_buf. */
+  packetbuf_attr_copyto(frag_attrs, frag_addrs);
 
   /* Send fragment */
   send_packet(dest);
 
-  /* Restore packetbuf from queuebuf */
-  queuebuf_to_packetbuf(q);
-  queuebuf_free(q);
+  packetbuf_clear();
+  packetbuf_attr_copyfrom(frag_attrs, frag_addrs);
 
   /* Check tx result. */
   if((last_tx_status == MAC_TX_COLLISION) ||
@@ -1603,6 +1832,199 @@ fragment_copy_payload_and_send(uint16_t uip_offset, linkaddr_t *dest) {
   }
   return 1;
 }
+#if SICSLOWPAN_FRAG_FORWARDING
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Find the VRB entry of a fragment from the packetbuf sender
+ * \param tag the tag of the fragment
+ * \param size the packet size announced in the fragment
+ * \return the entry, or NULL if the packet is not being forwarded
+ */
+static struct sicslowpan_vrb *
+vrb_lookup(uint16_t tag, uint16_t size)
+{
+  struct sicslowpan_vrb *vrb;
+  int i;
+
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    vrb = &vrb_table[i];
+    if(vrb->size == 0) {
+      continue;
+    }
+    if(timer_expired(&vrb->timer)) {
+      vrb->size = 0;
+      continue;
+    }
+    if(vrb->tag == tag &&
+       linkaddr_cmp(&vrb->sender, packetbuf_addr(PACKETBUF_ADDR_SENDER))) {
+      if(vrb->size != size) {
+        /* The sender reused the tag for another packet */
+        vrb->size = 0;
+        return NULL;
+      }
+      return vrb;
+    }
+  }
+  return NULL;
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Forward a subsequent fragment along the path of the first one
+ * \param vrb the entry installed by the first fragment
+ * \param offset the offset of the fragment in the received packet, in
+ * units of 8 bytes
+ * \param payload the fragment payload, which may be in packetbuf
+ * \param len the length of the payload
+ */
+static void
+vrb_forward_fragment(struct sicslowpan_vrb *vrb, uint8_t offset,
+                     const uint8_t *payload, uint16_t len)
+{
+  int out_offset;
+  uint16_t from, to, added;
+
+  if(linkaddr_cmp(&vrb->next_hop, &linkaddr_null)) {
+    /* The IP layer did not forward the first fragment */
+    UIP_STAT(++uip_stat.reass.drop);
+    return;
+  }
+
+  out_offset = (offset << 3) + vrb->offset_delta;
+  if((offset << 3) + len > vrb->size || out_offset <= 0 || (out_offset & 7)) {
+    LOG_WARN("forward: fragment outside of the packet (offset %u, len %u)\n",
+             offset << 3, len);
+    UIP_STAT(++uip_stat.reass.drop);
+    return;
+  }
+  timer_restart(&vrb->timer);
+
+  coverage_range(vrb->size, offset << 3, len, &from, &to);
+  added = coverage_update(vrb->coverage, from, to);
+  if(added == 0) {
+    /* Retransmitted fragment, already forwarded */
+    UIP_STAT(++uip_stat.reass.dup);
+    return;
+  }
+
+  /* The payload is moved to the front of packetbuf, behind a FRAGN header
+     for the next hop */
+  packetbuf_clear();
+  packetbuf_ptr = packetbuf_dataptr();
+  memmove(packetbuf_ptr + SICSLOWPAN_FRAGN_HDR_LEN, payload, len);
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+        ((SICSLOWPAN_DISPATCH_FRAGN << 8) | vrb->out_size));
+  SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, vrb->out_tag);
+  PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = out_offset >> 3;
+  packetbuf_set_datalen(SICSLOWPAN_FRAGN_HDR_LEN + len);
+
+  packetbuf_set_attr(PACKETBUF_ATTR_MAX_MAC_TRANSMISSIONS,
+                     vrb->max_mac_transmissions);
+#if LLSEC802154_USES_AUX_HEADER
+  packetbuf_set_attr(PACKETBUF_ATTR_SECURITY_LEVEL, vrb->llsec_level);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+  packetbuf_set_attr(PACKETBUF_ATTR_KEY_INDEX, vrb->llsec_key_id);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &vrb->next_hop);
+
+  /* The MAC payload depends on the addresses and security attributes just
+     set */
+  if(SICSLOWPAN_FRAGN_HDR_LEN + len > NETSTACK_MAC.max_payload()) {
+    LOG_WARN("forward: fragment too large for the next hop (tag %u, payload %u, MAC max payload %d)\n",
+             vrb->tag, len, NETSTACK_MAC.max_payload());
+    UIP_STAT(++uip_stat.reass.toolarge);
+    UIP_STAT(++uip_stat.reass.drop);
+    return;
+  }
+
+  LOG_INFO("forward: fragment (tag %u -> %u, payload %u, offset %u -> %d)\n",
+           vrb->tag, vrb->out_tag, len, offset << 3, out_offset);
+  UIP_STAT(++uip_stat.reass.forwarded);
+  vrb->forwarded = MIN(vrb->forwarded + (added << 3), vrb->size);
+  send_packet(&vrb->next_hop);
+}
+/*--------------------------------------------------------------------*/
+/**
+ * \brief Let the IP layer forward the first fragment of a packet that is
+ * not for us, without waiting for the rest of the packet
+ * \param context the reassembly context holding the first fragment
+ * \return 1 if the packet is handled by a VRB entry from now on, 0 if it
+ * is to be reassembled
+ */
+static int
+vrb_start(uint8_t context)
+{
+  struct sicslowpan_frag_info *info = &frag_info[context];
+  struct sicslowpan_frag_buf *buf;
+  struct sicslowpan_vrb *vrb;
+  uint16_t from, to;
+  int i;
+
+  /* Subsequent fragments are forwarded at their own offset, so the
+     first fragment has to end at a multiple of 8 bytes */
+  if(info->first_frag_len & 7) {
+    return 0;
+  }
+
+  memcpy(UIP_IP_BUF, info->first_frag, info->first_frag_len);
+  if(uip_is_addr_mcast(&UIP_IP_BUF->destipaddr) ||
+     uip_is_addr_linklocal(&UIP_IP_BUF->destipaddr) ||
+     uip_ds6_is_my_addr(&UIP_IP_BUF->destipaddr) ||
+     uip_ds6_is_my_aaddr(&UIP_IP_BUF->destipaddr)) {
+    return 0;
+  }
+
+  /* Use a free entry, or else one whose packet was forwarded entirely */
+  vrb = NULL;
+  for(i = 0; i < SICSLOWPAN_VRB_ENTRIES; i++) {
+    if(vrb_table[i].size == 0 || timer_expired(&vrb_table[i].timer)) {
+      vrb = &vrb_table[i];
+      break;
+    }
+    if(vrb == NULL && vrb_table[i].forwarded >= vrb_table[i].size) {
+      vrb = &vrb_table[i];
+    }
+  }
+  if(vrb == NULL) {
+    return 0;
+  }
+
+  linkaddr_copy(&vrb->sender, &info->sender);
+  vrb->tag = info->tag;
+  vrb->size = info->len;
+  linkaddr_copy(&vrb->next_hop, &linkaddr_null);
+  vrb->forwarded = 0;
+  memset(vrb->coverage, 0, sizeof(vrb->coverage));
+  timer_set(&vrb->timer, SICSLOWPAN_REASS_MAXAGE * CLOCK_SECOND / 16);
+
+  /* The IP layer processes the headers of the packet as if it were
+     complete. The part that was not received yet is zeroed, and output()
+     only sends what was received, recording the next hop in the entry. */
+  memset((uint8_t *)UIP_IP_BUF + info->first_frag_len, 0,
+         info->len - info->first_frag_len);
+  uip_len = info->len;
+  set_llsec_attrs();
+  vrb_pending = vrb;
+  vrb_pending_len = info->first_frag_len;
+  tcpip_input();
+  vrb_pending = NULL;
+
+  if(linkaddr_cmp(&vrb->next_hop, &linkaddr_null)) {
+    LOG_INFO("input: first fragment not forwarded, dropping packet (tag %u)\n",
+             info->tag);
+  } else {
+    vrb->forwarded = info->first_frag_len;
+    coverage_range(vrb->size, 0, info->first_frag_len, &from, &to);
+    coverage_update(vrb->coverage, from, to);
+    /* Forward the fragments that arrived ahead of the first one */
+    for(buf = list_head(info->frags); buf != NULL; buf = list_item_next(buf)) {
+      vrb_forward_fragment(vrb, buf->offset, buf->data, buf->len);
+    }
+  }
+  clear_fragments(context);
+  return 1;
+}
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 #endif /* SICSLOWPAN_CONF_FRAG */
 /*--------------------------------------------------------------------*/
 /** \brief Take an IP packet and format it to be sent on an 802.15.4
@@ -1622,6 +2044,16 @@ output(const linkaddr_t *localdest)
   /* The MAC address of the destination of the packet */
   linkaddr_t dest;
 
+#if SICSLOWPAN_FRAG_FORWARDING
+  struct sicslowpan_vrb *vrb = NULL;
+
+  if(vrb_pending != NULL && !uip_ds6_is_my_addr(&UIP_IP_BUF->srcipaddr)) {
+    /* The first fragment of a packet that is being forwarded */
+    vrb = vrb_pending;
+    vrb_pending = NULL;
+  }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
   /* init */
   uncomp_hdr_len = 0;
   packetbuf_hdr_len = 0;
@@ -1691,6 +2123,8 @@ output(const linkaddr_t *localdest)
     return 0;
   }
 #endif /* SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC */
+  UIP_STAT(sicslowpan_hc_stats.out_uncompressed += uncomp_hdr_len);
+  UIP_STAT(sicslowpan_hc_stats.out_compressed += packetbuf_hdr_len);
 
   /* Use the mac_max_payload to understand what is the max payload in a MAC
    * packet. We calculate it here only to make a better decision of whether
@@ -1704,12 +2138,44 @@ output(const linkaddr_t *localdest)
             uip_len, uip_len - uncomp_hdr_len + packetbuf_hdr_len,
             mac_max_payload, frag_needed);
 
+#if SICSLOWPAN_FRAG_FORWARDING
+  if(vrb != NULL) {
+    if(localdest == NULL) {
+      LOG_WARN("output: cannot forward fragments to broadcast\n");
+      return 0;
+    }
+    if((uip_len - vrb->size) & 7) {
+      /* The subsequent fragments are shifted by the change in header
+         length, and their offsets are in units of 8 bytes */
+      LOG_WARN("output: header length changed by %d bytes, cannot forward fragments\n",
+               uip_len - vrb->size);
+      return 0;
+    }
+    /* Only the first fragment can be sent for now */
+    frag_needed = 1;
+  }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
   if(frag_needed) {
 #if SICSLOWPAN_CONF_FRAG
     /* Number of bytes processed. */
     uint16_t processed_ip_out_len;
     uint16_t frag_tag;
     int curr_frag = 0;
+    /* Number of bytes of uip_buf to send */
+    uint16_t send_len = uip_len;
+
+#if SICSLOWPAN_FRAG_FORWARDING
+    if(vrb != NULL) {
+      /* What was received with the first fragment, with the headers as
+         updated by the IP layer */
+      send_len = vrb_pending_len + uip_len - vrb->size;
+      if(send_len < uncomp_hdr_len) {
+        LOG_WARN("output: headers not in the first fragment\n");
+        return 0;
+      }
+    }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 
     /*
      * The outbound IPv6 packet is too large to fit into a single 15.4
@@ -1720,9 +2186,10 @@ output(const linkaddr_t *localdest)
      * IPv6 payload (still multiple of 8 bytes, except for the last fragment)
      */
      /* Total IPv6 payload */
-    int total_payload = (uip_len - uncomp_hdr_len);
+    int total_payload = (send_len - uncomp_hdr_len);
     /* IPv6 payload that goes to first fragment */
-    int frag1_payload = (mac_max_payload - packetbuf_hdr_len - SICSLOWPAN_FRAG1_HDR_LEN) & 0xfffffff8;
+    int frag1_payload = MIN((mac_max_payload - packetbuf_hdr_len - SICSLOWPAN_FRAG1_HDR_LEN) & 0xfffffff8,
+                            total_payload);
     /* max IPv6 payload in each FRAGN. Must be multiple of 8 bytes */
     int fragn_max_payload = (mac_max_payload - SICSLOWPAN_FRAGN_HDR_LEN) & 0xfffffff8;
     /* max IPv6 payload in the last fragment. Needs not be multiple of 8 bytes */
@@ -1735,7 +2202,7 @@ output(const linkaddr_t *localdest)
       fragment_count += 1 + (middle_fragn_total_payload - 1) / fragn_max_payload;
     }
 
-    int freebuf = queuebuf_numfree() - 1;
+    int freebuf = queuebuf_numfree();
     LOG_INFO("output: fragmentation needed, fragments: %u, free queuebufs: %u\n",
       fragment_count, freebuf);
 
@@ -1781,27 +2248,28 @@ output(const linkaddr_t *localdest)
 
     /* Now prepare for subsequent fragments. */
 
-    /* FRAGN header: tag was already set at FRAG1. Now set dispatch for all FRAGN */
     packetbuf_hdr_len = SICSLOWPAN_FRAGN_HDR_LEN;
-    SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
-          ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
 
     /* Keep track of the total length of data sent */
     processed_ip_out_len = uncomp_hdr_len + packetbuf_payload_len;
 
     /* Create and send subsequent fragments. */
-    while(processed_ip_out_len < uip_len) {
+    while(processed_ip_out_len < send_len) {
       curr_frag++;
-      /* FRAGN header: set offset for this fragment */
+      /* FRAGN header: same dispatch, size and tag for all FRAGN, and the
+       * offset of this fragment */
+      SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE,
+            ((SICSLOWPAN_DISPATCH_FRAGN << 8) | uip_len));
+      SET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_TAG, frag_tag);
       PACKETBUF_FRAG_PTR[PACKETBUF_FRAG_OFFSET] = processed_ip_out_len >> 3;
 
       /* Calculate fragment len */
-      if(uip_len - processed_ip_out_len > last_fragn_max_payload) {
+      if(send_len - processed_ip_out_len > last_fragn_max_payload) {
         /* Not last fragment, send max FRAGN payload */
         packetbuf_payload_len = fragn_max_payload;
       } else {
         /* last fragment */
-        packetbuf_payload_len = uip_len - processed_ip_out_len;
+        packetbuf_payload_len = send_len - processed_ip_out_len;
       }
 
       /* Copy payload from uIP and send fragment */
@@ -1815,6 +2283,24 @@ output(const linkaddr_t *localdest)
 
       processed_ip_out_len += packetbuf_payload_len;
     }
+
+#if SICSLOWPAN_FRAG_FORWARDING
+    if(vrb != NULL) {
+      /* The subsequent fragments follow the same path */
+      linkaddr_copy(&vrb->next_hop, &dest);
+      vrb->out_tag = frag_tag;
+      vrb->out_size = uip_len;
+      vrb->offset_delta = uip_len - vrb->size;
+      vrb->max_mac_transmissions =
+        uipbuf_get_attr(UIPBUF_ATTR_MAX_MAC_TRANSMISSIONS);
+#if LLSEC802154_USES_AUX_HEADER
+      vrb->llsec_level = uipbuf_get_attr(UIPBUF_ATTR_LLSEC_LEVEL);
+#if LLSEC802154_USES_EXPLICIT_KEYS
+      vrb->llsec_key_id = uipbuf_get_attr(UIPBUF_ATTR_LLSEC_KEY_ID);
+#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
+#endif /* LLSEC802154_USES_AUX_HEADER */
+    }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 #else /* SICSLOWPAN_CONF_FRAG */
     LOG_ERR("output: Packet too large to be sent without fragmentation support; dropping packet\n");
     return 0;
@@ -1860,6 +2346,10 @@ input(void)
   uint8_t frag_offset = 0;
   uint8_t *buffer;
   uint16_t buffer_size;
+#if UIP_STATISTICS
+  /* Length of the headers before the compressed IPv6 header */
+  uint8_t hc_offset;
+#endif /* UIP_STATISTICS */
 
 #if SICSLOWPAN_CONF_FRAG
   uint8_t is_fragment = 0;
@@ -1868,6 +2358,9 @@ input(void)
   /* tag of the fragment */
   uint16_t frag_tag = 0;
   uint8_t first_fragment = 0, last_fragment = 0;
+#if SICSLOWPAN_FRAG_FORWARDING
+  struct sicslowpan_vrb *vrb;
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
 #endif /*SICSLOWPAN_CONF_FRAG*/
 
   /* Update link statistics */
@@ -1917,11 +2410,21 @@ input(void)
       LOG_INFO("input: received first element of a fragmented packet (tag %d, len %d)\n",
              frag_tag, frag_size);
 
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(vrb_lookup(frag_tag, frag_size) != NULL) {
+        /* Retransmission of a first fragment already forwarded */
+        UIP_STAT(++uip_stat.reass.dup);
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
       /* Add the fragment to the fragmentation context */
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
 
-      if(frag_context == -1) {
-        LOG_ERR("input: failed to allocate new reassembly context\n");
+      if(frag_context < 0) {
+        if(frag_context == -1) {
+          LOG_ERR("input: failed to allocate new reassembly context\n");
+        }
         return;
       }
 
@@ -1938,22 +2441,31 @@ input(void)
       frag_size = GET16(PACKETBUF_FRAG_PTR, PACKETBUF_FRAG_DISPATCH_SIZE) & 0x07ff;
       packetbuf_hdr_len += SICSLOWPAN_FRAGN_HDR_LEN;
 
+#if SICSLOWPAN_FRAG_FORWARDING
+      vrb = vrb_lookup(frag_tag, frag_size);
+      if(vrb != NULL) {
+        if(packetbuf_datalen() > packetbuf_hdr_len) {
+          vrb_forward_fragment(vrb, frag_offset, packetbuf_ptr + packetbuf_hdr_len,
+                               packetbuf_datalen() - packetbuf_hdr_len);
+        }
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
+
       /* Add the fragment to the fragmentation context (this will also
          copy the payload) */
       frag_context = add_fragment(frag_tag, frag_size, frag_offset);
 
-      if(frag_context == -1) {
-        LOG_ERR("input: reassembly context not found (tag %d)\n", frag_tag);
+      if(frag_context < 0) {
+        if(frag_context == -1) {
+          LOG_ERR("input: reassembly context not found (tag %d)\n", frag_tag);
+        }
         return;
       }
 
       /* Ok - add_fragment will store the fragment automatically - so
          we should not store more */
       buffer = NULL;
-
-      if(frag_info[frag_context].reassembled_len >= frag_size) {
-        last_fragment = 1;
-      }
       is_fragment = 1;
       break;
     default:
@@ -1966,6 +2478,8 @@ input(void)
   }
 #endif /* SICSLOWPAN_CONF_FRAG */
 
+  UIP_STAT(hc_offset = packetbuf_hdr_len);
+
   /* First, process 6LoRH headers */
   curr_page = 0;
   digest_paging_dispatch();
@@ -2000,6 +2514,8 @@ input(void)
              PACKETBUF_6LO_PTR[PACKETBUF_6LO_DISPATCH] & SICSLOWPAN_DISPATCH_IPHC_MASK);
     return;
   }
+  UIP_STAT(sicslowpan_hc_stats.in_compressed += packetbuf_hdr_len - hc_offset);
+  UIP_STAT(sicslowpan_hc_stats.in_uncompressed += uncomp_hdr_len);
 
 #if SICSLOWPAN_CONF_FRAG
  copypayload:
@@ -2059,13 +2575,18 @@ input(void)
   if(frag_size > 0) {
     /* Add the size of the header only for the first fragment. */
     if(first_fragment != 0) {
-      frag_info[frag_context].reassembled_len = uncomp_hdr_len + packetbuf_payload_len;
-      frag_info[frag_context].first_frag_len = uncomp_hdr_len + packetbuf_payload_len;
+      add_first_fragment(frag_context, uncomp_hdr_len + packetbuf_payload_len);
+#if SICSLOWPAN_FRAG_FORWARDING
+      if(!reassembly_complete(&frag_info[frag_context]) &&
+         vrb_start(frag_context)) {
+        return;
+      }
+#endif /* SICSLOWPAN_FRAG_FORWARDING */
     }
-    /* For the last fragment, we are OK if there is extrenous bytes at
-       the end of the packet. */
-    if(last_fragment != 0) {
-      frag_info[frag_context].reassembled_len = frag_size;
+    /* Whichever fragment completes the packet is the last one. We are OK
+       if there is extrenous bytes at the end of the packet. */
+    if(reassembly_complete(&frag_info[frag_context])) {
+      last_fragment = 1;
       /* copy to uip */
       if(!copy_frags2uip(frag_context)) {
         return;
@@ -2106,18 +2627,7 @@ input(void)
       callback->input_callback();
     }
 
-#if LLSEC802154_USES_AUX_HEADER
-    /*
-     * Assuming that the last packet in packetbuf is containing
-     *  the LLSEC state so that it can be copied to uipbuf.
-     */
-    uipbuf_set_attr(UIPBUF_ATTR_LLSEC_LEVEL,
-      packetbuf_attr(PACKETBUF_ATTR_SECURITY_LEVEL));
-#if LLSEC802154_USES_EXPLICIT_KEYS
-    uipbuf_set_attr(UIPBUF_ATTR_LLSEC_KEY_ID,
-      packetbuf_attr(PACKETBUF_ATTR_KEY_INDEX));
-#endif /* LLSEC802154_USES_EXPLICIT_KEYS */
-#endif /*  LLSEC802154_USES_AUX_HEADER */
+    set_llsec_attrs();
 
     tcpip_input();
 #if SICSLOWPAN_CONF_FRAG
@@ -2132,50 +2642,87 @@ input(void)
 void
 sicslowpan_init(void)
 {
+#if SICSLOWPAN_CONF_FRAG
+  memb_init(&frag_buf_memb);
+#endif /* SICSLOWPAN_CONF_FRAG */
+
+#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+  {
+    uint8_t i;
+    for(i = 0; i < SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS; i++) {
+      sicslowpan_addr_context_reset(i);
+    }
+  }
+#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
+}
+/*--------------------------------------------------------------------*/
+void
+sicslowpan_addr_context_reset(uint8_t number)
+{
+#if SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+  if(number >= SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS) {
+    return;
+  }
+  memset(&addr_contexts[number], 0, sizeof(addr_contexts[number]));
+  addr_contexts[number].number = number;
 
-#if SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC
 /* Preinitialize any address contexts for better header compression
  * (Saves up to 13 bytes per 6lowpan packet)
  * The platform contiki-conf.h file can override this using e.g.
  * #define SICSLOWPAN_CONF_ADDR_CONTEXT_0 {addr_contexts[0].prefix[0]=0xbb;addr_contexts[0].prefix[1]=0xbb;}
  */
-#if SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
-  addr_contexts[0].used   = 1;
-  addr_contexts[0].number = 0;
+  if(number == 0) {
+    addr_contexts[0].used = 1;
 #ifdef SICSLOWPAN_CONF_ADDR_CONTEXT_0
-  SICSLOWPAN_CONF_ADDR_CONTEXT_0;
+    SICSLOWPAN_CONF_ADDR_CONTEXT_0;
 #else
-  addr_contexts[0].prefix[0] = UIP_DS6_DEFAULT_PREFIX_0;
-  addr_contexts[0].prefix[1] = UIP_DS6_DEFAULT_PREFIX_1;
+    addr_contexts[0].prefix[0] = UIP_DS6_DEFAULT_PREFIX_0;
+    addr_contexts[0].prefix[1] = UIP_DS6_DEFAULT_PREFIX_1;
 #endif
-#endif /* SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0 */
-
-#if SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 1
-  {
-    int i;
-    for(i = 1; i < SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS; i++) {
-#ifdef SICSLOWPAN_CONF_ADDR_CONTEXT_1
-      if (i==1) {
-        addr_contexts[1].used   = 1;
-        addr_contexts[1].number = 1;
-        SICSLOWPAN_CONF_ADDR_CONTEXT_1;
-#ifdef SICSLOWPAN_CONF_ADDR_CONTEXT_2
-      } else if (i==2) {
-        addr_contexts[2].used   = 1;
-        addr_contexts[2].number = 2;
-        SICSLOWPAN_CONF_ADDR_CONTEXT_2;
+  }
+#if SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 1 && defined(SICSLOWPAN_CONF_ADDR_CONTEXT_1)
+  if(number == 1) {
+    addr_contexts[1].used = 1;
+    SICSLOWPAN_CONF_ADDR_CONTEXT_1;
+  }
 #endif
-      } else {
-        addr_contexts[i].used = 0;
-      }
-#else
-      addr_contexts[i].used = 0;
-#endif /* SICSLOWPAN_CONF_ADDR_CONTEXT_1 */
-    }
+#if SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 2 && defined(SICSLOWPAN_CONF_ADDR_CONTEXT_1) && defined(SICSLOWPAN_CONF_ADDR_CONTEXT_2)
+  if(number == 2) {
+    addr_contexts[2].used = 1;
+    SICSLOWPAN_CONF_ADDR_CONTEXT_2;
   }
-#endif /* SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 1 */
+#endif
+  LOG_DBG("address context %u reset\n", number);
+#endif
+}
+/*--------------------------------------------------------------------*/
+int
+sicslowpan_addr_context_set(uint8_t number, const uip_ipaddr_t *prefix)
+{
+#if SICSLOWPAN_COMPRESSION >= SICSLOWPAN_COMPRESSION_IPHC && SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS > 0
+  struct sicslowpan_addr_context *c;
 
-#endif /* SICSLOWPAN_COMPRESSION == SICSLOWPAN_COMPRESSION_IPHC */
+  if(number >= SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS) {
+    return 0;
+  }
+  c = &addr_contexts[number];
+  if(prefix == NULL) {
+    c->used = 0;
+    return 1;
+  }
+  if(c->used == 1 && memcmp(c->prefix, prefix, sizeof(c->prefix)) == 0) {
+    return 1;
+  }
+  LOG_INFO("address context %u set to ", number);
+  LOG_INFO_6ADDR(prefix);
+  LOG_INFO_("\n");
+  c->used = 1;
+  c->number = number;
+  memcpy(c->prefix, prefix, sizeof(c->prefix));
+  return 1;
+#else
+  return 0;
+#endif
 }
 /*--------------------------------------------------------------------*/
 int
@@ -336,6 +336,41 @@ struct sicslowpan_nh_compressor {
 
 };
 
+/**
+ * \brief Header compression statistics, in bytes of headers. The ratio
+ * of compressed to uncompressed bytes tells how well the address
+ * contexts fit the traffic.
+ */
+struct sicslowpan_hc_stats {
+  uint32_t out_uncompressed; /**< Headers sent, before compression */
+  uint32_t out_compressed;   /**< Headers sent, after compression */
+  uint32_t in_compressed;    /**< Headers received, as compressed */
+  uint32_t in_uncompressed;  /**< Headers received, once uncompressed */
+};
+
+#if UIP_STATISTICS
+extern struct sicslowpan_hc_stats sicslowpan_hc_stats;
+#endif /* UIP_STATISTICS */
+
+/**
+ * \brief Set an address context for IPHC compression. All nodes of the
+ * network must agree on the contexts, which are therefore typically
+ * learned from the routing protocol.
+ * \param number The context number, below SICSLOWPAN_CONF_MAX_ADDR_CONTEXTS
+ * \param prefix The address whose first 64 bits are the context prefix,
+ * or NULL to remove the context
+ * \return 1 if the context was set, 0 otherwise
+ */
+int sicslowpan_addr_context_set(uint8_t number, const uip_ipaddr_t *prefix);
+
+/**
+ * \brief Restore an address context to its compile-time value, as set
+ * with SICSLOWPAN_CONF_ADDR_CONTEXT_0 to _2 or the default prefix for
+ * context 0. A context without a compile-time value is removed.
+ * \param number The context number
+ */
+void sicslowpan_addr_context_reset(uint8_t number);
+
 extern CC_DEPRECATED("Use UIPBUF_ATTR_RSSI instead") int sicslowpan_get_last_rssi(void);
 
 extern const struct network_driver sicslowpan_driver;
@@ -89,8 +89,23 @@ LIST(routelist);
 MEMB(routememb, uip_ds6_route_t, UIP_DS6_ROUTE_NB);
 
 static int num_routes = 0;
+/* Number of neighbors with at least one route going through them */
+static int num_nexthops = 0;
+/* Number of routes shorter than /128, which need a longest-prefix scan */
+static int num_prefix_routes = 0;
 static void rm_routelist_callback(nbr_table_item_t *ptr);
 
+/* Hash index of the /128 host routes: open addressing with linear probing,
+   at most half full. Each slot holds the index of the route in routememb
+   plus one, or zero when empty. */
+#define HOST_ROUTE_INDEX_SIZE (2 * UIP_DS6_ROUTE_NB + 1)
+#if UIP_DS6_ROUTE_NB < 0xff
+typedef uint8_t host_route_index_slot_t;
+#else
+typedef uint16_t host_route_index_slot_t;
+#endif
+static host_route_index_slot_t host_route_index[HOST_ROUTE_INDEX_SIZE];
+
 #endif /* (UIP_MAX_ROUTES != 0) */
 
 /* Default routes are held on the defaultrouterlist and their
@@ -168,12 +183,101 @@ uip_ds6_notification_rm(struct uip_ds6_notification *n)
 }
 #endif
 /*---------------------------------------------------------------------------*/
+#if (UIP_MAX_ROUTES != 0)
+static uip_ds6_route_t *
+route_from_index(host_route_index_slot_t index)
+{
+  return &routememb_memb_mem[index];
+}
+/*---------------------------------------------------------------------------*/
+/* The slot of the host route index where probing for an address starts */
+static unsigned
+host_route_index_home(const uip_ipaddr_t *addr)
+{
+  unsigned hash = 0;
+  int i;
+  for(i = 0; i < sizeof(uip_ipaddr_t); i++) {
+    hash = hash * 33 + addr->u8[i];
+  }
+  return hash % HOST_ROUTE_INDEX_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+host_route_index_next(unsigned slot)
+{
+  return slot + 1 == HOST_ROUTE_INDEX_SIZE ? 0 : slot + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Get the slot of the host route index holding an address,
+   or the empty slot where it would go */
+static unsigned
+host_route_index_lookup(const uip_ipaddr_t *addr)
+{
+  unsigned slot = host_route_index_home(addr);
+  while(host_route_index[slot] != 0
+        && !uip_ipaddr_cmp(addr, &route_from_index(host_route_index[slot] - 1)->ipaddr)) {
+    slot = host_route_index_next(slot);
+  }
+  return slot;
+}
+/*---------------------------------------------------------------------------*/
+/* Account for a new route in the host route index or the prefix count */
+static void
+host_route_index_add(uip_ds6_route_t *r)
+{
+  if(r->length == 128) {
+    host_route_index[host_route_index_lookup(&r->ipaddr)] =
+      r - routememb_memb_mem + 1;
+  } else {
+    num_prefix_routes++;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Undo host_route_index_add(). The entries that follow a removed host route
+   in the same probe sequence are moved back, so that they can still be
+   found. */
+static void
+host_route_index_remove(uip_ds6_route_t *r)
+{
+  unsigned hole;
+  unsigned slot;
+
+  if(r->length != 128) {
+    num_prefix_routes--;
+    return;
+  }
+  hole = host_route_index_lookup(&r->ipaddr);
+  slot = hole;
+  if(host_route_index[hole] == 0) {
+    return;
+  }
+  while(1) {
+    unsigned home;
+    slot = host_route_index_next(slot);
+    if(host_route_index[slot] == 0) {
+      break;
+    }
+    home = host_route_index_home(&route_from_index(host_route_index[slot] - 1)->ipaddr);
+    /* The entry stays if its home slot is cyclically within ]hole, slot] */
+    if(hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot)) {
+      continue;
+    }
+    host_route_index[hole] = host_route_index[slot];
+    hole = slot;
+  }
+  host_route_index[hole] = 0;
+}
+#endif /* (UIP_MAX_ROUTES != 0) */
+/*---------------------------------------------------------------------------*/
 void
 uip_ds6_route_init(void)
 {
 #if (UIP_MAX_ROUTES != 0)
   memb_init(&routememb);
   list_init(routelist);
+  memset(host_route_index, 0, sizeof(host_route_index));
+  num_prefix_routes = 0;
+  num_nexthops = 0;
   nbr_table_register(nbr_routes,
                      (nbr_table_callback *)rm_routelist_callback);
 #endif /* (UIP_MAX_ROUTES != 0) */
@@ -190,12 +294,7 @@ int
 uip_ds6_route_count_nexthop_neighbors(void)
 {
 #if (UIP_MAX_ROUTES != 0)
-  struct uip_ds6_route_neighbor_routes *entry;
-  int count = 0;
-  for(entry = nbr_table_head(nbr_routes); entry != NULL; entry = nbr_table_next(nbr_routes, entry)) {
-    count++;
-  }
-  return count;
+  return num_nexthops;
 #else /* (UIP_MAX_ROUTES != 0) */
   return 0;
 #endif /* (UIP_MAX_ROUTES != 0) */
@@ -268,6 +367,23 @@ uip_ds6_route_is_nexthop(const uip_ipaddr_t *ipaddr)
 }
 /*---------------------------------------------------------------------------*/
 int
+uip_ds6_route_num_routes_via(const uip_lladdr_t *lladdr)
+{
+#if (UIP_MAX_ROUTES != 0)
+  struct uip_ds6_route_neighbor_routes *routes;
+
+  if(lladdr == NULL) {
+    return 0;
+  }
+
+  routes = nbr_table_get_from_lladdr(nbr_routes, (linkaddr_t *)lladdr);
+  return routes != NULL ? routes->num_routes : 0;
+#else /* (UIP_MAX_ROUTES != 0) */
+  return 0;
+#endif /* (UIP_MAX_ROUTES != 0) */
+}
+/*---------------------------------------------------------------------------*/
+int
 uip_ds6_route_num_routes(void)
 {
 #if (UIP_MAX_ROUTES != 0)
@@ -284,50 +400,54 @@ uip_ds6_route_lookup(const uip_ipaddr_t *addr)
   uip_ds6_route_t *r;
   uip_ds6_route_t *found_route;
   uint8_t longestmatch;
-
-  LOG_INFO("Looking up route for ");
-  LOG_INFO_6ADDR(addr);
-  LOG_INFO_("\n");
+  host_route_index_slot_t index;
 
   if(addr == NULL) {
     return NULL;
   }
 
+  /* A host route is always the longest match, so try the index first and
+     only scan the routes shorter than /128 if there is none. */
   found_route = NULL;
-  longestmatch = 0;
-  for(r = uip_ds6_route_head();
-      r != NULL;
-      r = uip_ds6_route_next(r)) {
-    if(r->length >= longestmatch &&
-       uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
-      longestmatch = r->length;
-      found_route = r;
-      /* check if total match - e.g. all 128 bits do match */
-      if(longestmatch == 128) {
-	break;
+  index = host_route_index[host_route_index_lookup(addr)];
+  if(index != 0) {
+    found_route = route_from_index(index - 1);
+  } else if(num_prefix_routes > 0) {
+    longestmatch = 0;
+    for(r = uip_ds6_route_head();
+        r != NULL;
+        r = uip_ds6_route_next(r)) {
+      if(r->length < 128 && r->length >= longestmatch &&
+         uip_ipaddr_prefixcmp(addr, &r->ipaddr, r->length)) {
+        longestmatch = r->length;
+        found_route = r;
       }
     }
   }
 
-  if(found_route != NULL) {
-    LOG_INFO("Found route: ");
-    LOG_INFO_6ADDR(addr);
-    LOG_INFO_(" via ");
-    LOG_INFO_6ADDR(uip_ds6_route_nexthop(found_route));
-    LOG_INFO_("\n");
-  } else {
-    LOG_WARN("No route found\n");
+  if(LOG_DBG_ENABLED) {
+    LOG_DBG("Lookup: ");
+    LOG_DBG_6ADDR(addr);
+    if(found_route != NULL) {
+      LOG_DBG_(" via ");
+      LOG_DBG_6ADDR(uip_ds6_route_nexthop(found_route));
+      LOG_DBG_("\n");
+    } else {
+      LOG_DBG_(": no route found\n");
+    }
   }
 
+#if UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED
   if(found_route != NULL && found_route != list_head(routelist)) {
     /* If we found a route, we put it at the start of the routeslist
        list. The list is ordered by how recently we looked them up:
        the least recently used route will be at the end of the
-       list - for fast lookups (assuming multiple packets to the same node). */
+       list, where uip_ds6_route_add() picks it for eviction. */
 
     list_remove(routelist, found_route);
     list_push(routelist, found_route);
   }
+#endif /* UIP_DS6_ROUTE_REMOVE_LEAST_RECENTLY_USED */
 
   return found_route;
 #else /* (UIP_MAX_ROUTES != 0) */
@@ -339,7 +459,6 @@ uip_ds6_route_t *
 uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
                   const uip_ipaddr_t *nexthop)
 {
-  printf("Routing uip_ds6_route_add \t");
 #if (UIP_MAX_ROUTES != 0)
   uip_ds6_route_t *r;
   struct uip_ds6_route_neighbor_route *nbrr;
@@ -413,8 +532,6 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
     routes = nbr_table_get_from_lladdr(nbr_routes,
                                        (linkaddr_t *)nexthop_lladdr);
 
-    printf("Routing: routes = %u number of routes \n", routes);
-
     if(routes == NULL) {
       /* If the neighbor did not have an entry in our neighbor table,
          we create one. The nbr_table_add_lladdr() function returns a
@@ -431,6 +548,7 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
         return NULL;
       }
       LIST_STRUCT_INIT(routes, route_list);
+      routes->num_routes = 0;
 #ifdef NETSTACK_CONF_ROUTING_NEIGHBOR_ADDED_CALLBACK
       NETSTACK_CONF_ROUTING_NEIGHBOR_ADDED_CALLBACK((const linkaddr_t *)nexthop_lladdr);
 #endif
@@ -462,6 +580,9 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
     nbrr->route = r;
     /* Add the route to this neighbor */
     list_add(routes->route_list, nbrr);
+    if(routes->num_routes++ == 0) {
+      num_nexthops++;
+    }
     r->neighbor_routes = routes;
     num_routes++;
 
@@ -473,6 +594,7 @@ uip_ds6_route_add(const uip_ipaddr_t *ipaddr, uint8_t length,
 
   uip_ipaddr_copy(&(r->ipaddr), ipaddr);
   r->length = length;
+  host_route_index_add(r);
 
 #ifdef UIP_DS6_ROUTE_STATE_TYPE
   memset(&r->state, 0, sizeof(UIP_DS6_ROUTE_STATE_TYPE));
@@ -516,8 +638,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
     LOG_INFO_6ADDR(&route->ipaddr);
     LOG_INFO_("\n");
 
-    /* Remove the route from the route list */
+    /* Remove the route from the route list and index */
     list_remove(routelist, route);
+    host_route_index_remove(route);
 
     /* Find the corresponding neighbor_route and remove it. */
     for(neighbor_route = list_head(route->neighbor_routes->route_list);
@@ -530,6 +653,9 @@ uip_ds6_route_rm(uip_ds6_route_t *route)
       LOG_INFO_("\n");
     }
     list_remove(route->neighbor_routes->route_list, neighbor_route);
+    if(neighbor_route != NULL && --route->neighbor_routes->num_routes == 0) {
+      num_nexthops--;
+    }
     if(list_head(route->neighbor_routes->route_list) == NULL) {
       /* If this was the only route using this neighbor, remove the
          neighbor from the table - this implicitly unlocks nexthop */
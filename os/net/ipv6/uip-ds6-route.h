@@ -165,6 +165,8 @@ typedef struct rpl_route_entry {
     that are attached to a specific neihbor. */
 struct uip_ds6_route_neighbor_routes {
   LIST_STRUCT(route_list);
+  /* The number of entries on route_list */
+  uint16_t num_routes;
 };
 
 /** \brief An entry in the routing table */
@@ -225,6 +227,15 @@ uip_ds6_route_t *uip_ds6_route_head(void);
 uip_ds6_route_t *uip_ds6_route_next(uip_ds6_route_t *);
 int uip_ds6_route_is_nexthop(const uip_ipaddr_t *ipaddr);
 int uip_ds6_route_count_nexthop_neighbors(void);
+
+/**
+ * \brief Get the number of routes that go through a next hop. On a
+ * storing-mode node, this is the size of the sub-DODAG of that child.
+ * The count is kept up to date on route add and removal, so this is O(1).
+ * \param lladdr The link-layer address of the next hop
+ * \return The number of routes via the next hop, 0 if there are none
+ */
+int uip_ds6_route_num_routes_via(const uip_lladdr_t *lladdr);
 /** @} */
 
 #endif /* UIP_DS6_ROUTE_H */
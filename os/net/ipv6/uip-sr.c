@@ -58,6 +58,16 @@ static int num_nodes;
 LIST(nodelist);
 MEMB(nodememb, uip_sr_node_t, UIP_SR_LINK_NUM);
 
+/* Incremented whenever a source route may have changed, which invalidates
+   all cached source routing headers */
+static uint32_t generation;
+
+#if UIP_SR_SRH_CACHE_SIZE
+static uip_sr_srh_cache_t srh_cache[UIP_SR_SRH_CACHE_SIZE];
+/* The entry to replace next, entries are replaced round-robin */
+static uint8_t srh_cache_next;
+#endif /* UIP_SR_SRH_CACHE_SIZE */
+
 /*---------------------------------------------------------------------------*/
 int
 uip_sr_num_nodes(void)
@@ -65,6 +75,51 @@ uip_sr_num_nodes(void)
   return num_nodes;
 }
 /*---------------------------------------------------------------------------*/
+const uip_sr_srh_cache_t *
+uip_sr_srh_cache_lookup(void *graph, const uip_ipaddr_t *dest)
+{
+#if UIP_SR_SRH_CACHE_SIZE
+  int i;
+  for(i = 0; i < UIP_SR_SRH_CACHE_SIZE; i++) {
+    if(srh_cache[i].generation == generation
+       && srh_cache[i].graph == graph
+       && uip_ipaddr_cmp(&srh_cache[i].dest, dest)) {
+      return &srh_cache[i];
+    }
+  }
+#endif /* UIP_SR_SRH_CACHE_SIZE */
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+uip_sr_srh_cache_t *
+uip_sr_srh_cache_add(void *graph, const uip_ipaddr_t *dest)
+{
+#if UIP_SR_SRH_CACHE_SIZE
+  uip_sr_srh_cache_t *entry;
+  int i;
+
+  /* Reuse the stale entry of this destination if there is one */
+  for(i = 0; i < UIP_SR_SRH_CACHE_SIZE; i++) {
+    if(srh_cache[i].graph == graph
+       && uip_ipaddr_cmp(&srh_cache[i].dest, dest)) {
+      break;
+    }
+  }
+  if(i == UIP_SR_SRH_CACHE_SIZE) {
+    i = srh_cache_next;
+    srh_cache_next = (srh_cache_next + 1) % UIP_SR_SRH_CACHE_SIZE;
+  }
+
+  entry = &srh_cache[i];
+  entry->graph = graph;
+  uip_ipaddr_copy(&entry->dest, dest);
+  entry->generation = generation;
+  return entry;
+#else /* UIP_SR_SRH_CACHE_SIZE */
+  return NULL;
+#endif /* UIP_SR_SRH_CACHE_SIZE */
+}
+/*---------------------------------------------------------------------------*/
 static int
 node_matches_address(void *graph, const uip_sr_node_t *node, const uip_ipaddr_t *addr)
 {
@@ -125,6 +180,8 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child, const uip_ipaddr_t *p
   uip_sr_node_t *child_node = uip_sr_get_node(graph, child);
   uip_sr_node_t *parent_node = uip_sr_get_node(graph, parent);
   uip_sr_node_t *old_parent_node;
+  uip_sr_node_t *prev_parent_node;
+  void *prev_graph;
 
   if(parent != NULL) {
     /* No node for the parent, add one with infinite lifetime */
@@ -152,6 +209,9 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child, const uip_ipaddr_t *p
     num_nodes++;
   }
 
+  prev_parent_node = child_node->parent;
+  prev_graph = child_node->graph;
+
   /* Initialize node */
   child_node->graph = graph;
   child_node->lifetime = lifetime;
@@ -173,6 +233,11 @@ uip_sr_update_node(void *graph, const uip_ipaddr_t *child, const uip_ipaddr_t *p
     child_node->parent = parent_node;
   }
 
+  /* A DAO that only refreshes the lifetime keeps the cached headers */
+  if(child_node->parent != prev_parent_node || child_node->graph != prev_graph) {
+    generation++;
+  }
+
   LOG_INFO("NS: updating link, child ");
   LOG_INFO_6ADDR(child);
   LOG_INFO_(", parent ");
@@ -188,6 +253,7 @@ uip_sr_init(void)
   num_nodes = 0;
   memb_init(&nodememb);
   list_init(nodelist);
+  generation++;
 }
 /*---------------------------------------------------------------------------*/
 uip_sr_node_t *
@@ -229,6 +295,7 @@ uip_sr_periodic(unsigned seconds)
       list_remove(nodelist, l);
       memb_free(&nodememb, l);
       num_nodes--;
+      generation++;
     } else if(l->lifetime != UIP_SR_INFINITE_LIFETIME) {
       l->lifetime = l->lifetime > seconds ? l->lifetime - seconds : 0;
     }
@@ -246,6 +313,7 @@ uip_sr_free_all(void)
     memb_free(&nodememb, l);
     num_nodes--;
   }
+  generation++;
 }
 /*---------------------------------------------------------------------------*/
 int
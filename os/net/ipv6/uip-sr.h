@@ -85,6 +85,21 @@
 
 #define UIP_SR_INFINITE_LIFETIME           0xFFFFFFFF
 
+/* The number of destinations whose source routing header is cached */
+#ifdef UIP_SR_CONF_SRH_CACHE_SIZE
+#define UIP_SR_SRH_CACHE_SIZE UIP_SR_CONF_SRH_CACHE_SIZE
+#else /* UIP_SR_CONF_SRH_CACHE_SIZE */
+#define UIP_SR_SRH_CACHE_SIZE (UIP_SR_LINK_NUM != 0 ? 4 : 0)
+#endif /* UIP_SR_CONF_SRH_CACHE_SIZE */
+
+/* The maximum size of the compressed addresses of a cached source routing
+ * header. Longer source routes are not cached. */
+#ifdef UIP_SR_CONF_SRH_CACHE_ADDR_LEN
+#define UIP_SR_SRH_CACHE_ADDR_LEN UIP_SR_CONF_SRH_CACHE_ADDR_LEN
+#else /* UIP_SR_CONF_SRH_CACHE_ADDR_LEN */
+#define UIP_SR_SRH_CACHE_ADDR_LEN 48
+#endif /* UIP_SR_CONF_SRH_CACHE_ADDR_LEN */
+
 /********** Data Structures  **********/
 
 /** \brief A node in a source routing graph, stored at the root and representing
@@ -100,6 +115,25 @@ typedef struct uip_sr_node {
   struct uip_sr_node *parent;
 } uip_sr_node_t;
 
+/** \brief The source routing header computed for a destination. It remains
+ * valid as long as the source routing graph does not change. */
+typedef struct uip_sr_srh_cache {
+  /* The graph and destination the header was computed for */
+  void *graph;
+  uip_ipaddr_t dest;
+  /* The first hop, i.e. the IPv6 destination of the packet */
+  uip_ipaddr_t next_hop;
+  /* Graph generation the header was computed at */
+  uint32_t generation;
+  /* Number of addresses in the header (Segments Left) */
+  uint8_t path_len;
+  /* Number of prefix bytes elided from every address (ComprI = ComprE) */
+  uint8_t cmpr;
+  /* The compressed addresses, from first to last */
+  uint8_t addr_len;
+  uint8_t addresses[UIP_SR_SRH_CACHE_ADDR_LEN];
+} uip_sr_srh_cache_t;
+
 /********** Public functions **********/
 
 /**
@@ -162,6 +196,27 @@ uip_sr_node_t *uip_sr_get_node(void *graph, const uip_ipaddr_t *addr);
 */
 int uip_sr_is_addr_reachable(void *graph, const uip_ipaddr_t *addr);
 
+/**
+ * Looks up the cached source routing header for a destination. Entries
+ * computed before the last change of the source routing graph are ignored.
+ *
+ * \param graph The graph the destination belongs to
+ * \param dest The destination IPv6 global address
+ * \return The cached header, or NULL if there is none
+*/
+const uip_sr_srh_cache_t *uip_sr_srh_cache_lookup(void *graph, const uip_ipaddr_t *dest);
+
+/**
+ * Allocates a cache entry for a destination, replacing the entry of the
+ * same destination or the oldest one. The entry is stamped with the
+ * current graph generation, the caller fills in the header fields.
+ *
+ * \param graph The graph the destination belongs to
+ * \param dest The destination IPv6 global address
+ * \return The entry, or NULL if the cache is disabled
+*/
+uip_sr_srh_cache_t *uip_sr_srh_cache_add(void *graph, const uip_ipaddr_t *dest);
+
 /**
  * A function called periodically. Used to age the links (decrease lifetime
  * and expire links accordingly)
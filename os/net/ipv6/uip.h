@@ -1477,6 +1477,19 @@ struct uip_stats {
     uip_stats_t recv;     /**< Number of recived ND6 packets */
     uip_stats_t sent;     /**< Number of sent ND6 packets */
   } nd6;
+  struct {
+    uip_stats_t complete; /**< Number of packets reassembled from
+                               6LoWPAN fragments. */
+    uip_stats_t dup;      /**< Number of duplicate fragments ignored. */
+    uip_stats_t drop;     /**< Number of fragments dropped. */
+    uip_stats_t timeout;  /**< Number of reassemblies that timed out. */
+    uip_stats_t evicted;  /**< Number of reassemblies evicted to make
+                               room for another one. */
+    uip_stats_t forwarded; /**< Number of fragments forwarded without
+                                reassembly. */
+    uip_stats_t toolarge; /**< Number of fragments too large to be
+                               forwarded to the next hop. */
+  } reass;                /**< 6LoWPAN reassembly statistics. */
 };
 
 
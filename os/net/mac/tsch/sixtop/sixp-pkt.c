@@ -54,142 +54,151 @@
 #define LOG_MODULE "6top"
 #define LOG_LEVEL LOG_LEVEL_6TOP
 
-static int32_t get_metadata_offset(sixp_pkt_type_t type, sixp_pkt_code_t code);
-static int32_t get_cell_options_offset(sixp_pkt_type_t type,
-                                       sixp_pkt_code_t code);
-static int32_t get_num_cells_offset(sixp_pkt_type_t type, sixp_pkt_code_t code);
-static int32_t get_reserved_offset(sixp_pkt_type_t type, sixp_pkt_code_t code);
-static int32_t get_offset_offset(sixp_pkt_type_t type, sixp_pkt_code_t code);
-static int32_t get_max_num_cells_offset(sixp_pkt_type_t type,
-                                        sixp_pkt_code_t code);
-static int32_t get_cell_list_offset(sixp_pkt_type_t type, sixp_pkt_code_t code);
-static int32_t get_rel_cell_list_offset(sixp_pkt_type_t type,
-                                        sixp_pkt_code_t code);
-static int32_t get_total_num_cells_offset(sixp_pkt_type_t type,
-                                          sixp_pkt_code_t code);
-static int32_t get_payload_offset(sixp_pkt_type_t type,
-                                  sixp_pkt_code_t code);
+/*
+ * The position of each field in "Other Fields" only depends on the message
+ * type and code, so it is kept in a table rather than being computed field by
+ * field. The same table drives the length checks of sixp_pkt_parse().
+ */
+typedef enum {
+  FIELD_METADATA,
+  FIELD_CELL_OPTIONS,
+  FIELD_NUM_CELLS,
+  FIELD_RESERVED,
+  FIELD_OFFSET,
+  FIELD_MAX_NUM_CELLS,
+  FIELD_CELL_LIST,
+  FIELD_REL_CELL_LIST,
+  FIELD_TOTAL_NUM_CELLS,
+  FIELD_PAYLOAD,
+  FIELD_COUNT
+} sixp_pkt_field_t;
+
+/* The message doesn't have the field */
+#define NO_FIELD 0xff
+
+/* "Other Fields" must be exactly min_len long */
+#define LEN_EXACT         0x01
+/* Whatever follows min_len is made of whole cells */
+#define LEN_CELL_ALIGNED  0x02
+
+typedef struct {
+  uint8_t offset[FIELD_COUNT];
+  uint8_t min_len;
+  uint8_t len_flags;
+} sixp_pkt_layout_t;
+
+#define NF NO_FIELD
+#define LAYOUT(metadata, cell_options, num_cells, reserved, offset,     \
+               max_num_cells, cell_list, rel_cell_list, total_num_cells, \
+               payload, min_len, len_flags)                             \
+  { { metadata, cell_options, num_cells, reserved, offset,              \
+      max_num_cells, cell_list, rel_cell_list, total_num_cells,          \
+      payload }, min_len, len_flags }
+
+/*
+ * Columns: Metadata, CellOptions, NumCells, Reserved, Offset, MaxNumCells,
+ * CellList, RelCellList (followed by CandCellList), TotalNumCells, Payload,
+ * then the minimum length of "Other Fields" and how it may grow.
+ */
+
+/* Requests, indexed by command identifier; ADD is 1 */
+static const sixp_pkt_layout_t request_layouts[] = {
+  /* ADD */
+  LAYOUT(0, 2, 3, NF, NF, NF, 4, NF, NF, NF, 4, LEN_CELL_ALIGNED),
+  /* DELETE */
+  LAYOUT(0, 2, 3, NF, NF, NF, 4, NF, NF, NF, 4, LEN_CELL_ALIGNED),
+  /* RELOCATE */
+  LAYOUT(0, 2, 3, NF, NF, NF, NF, 4, NF, NF, 4, LEN_CELL_ALIGNED),
+  /* COUNT */
+  LAYOUT(0, 2, NF, NF, NF, NF, NF, NF, NF, NF, 3, LEN_EXACT),
+  /* LIST */
+  LAYOUT(0, 2, NF, 3, 4, 6, NF, NF, NF, NF, 8, LEN_EXACT),
+  /* SIGNAL */
+  LAYOUT(0, NF, NF, NF, NF, NF, NF, NF, NF, 2, 2, 0),
+  /* CLEAR */
+  LAYOUT(0, NF, NF, NF, NF, NF, NF, NF, NF, NF, 2, LEN_EXACT),
+};
+
+/*
+ * Responses, indexed by return code. The body of a successful response
+ * depends on the command it answers, hence any length is accepted:
+ * - Res to CLEAR:             Empty (length 0)
+ * - Res to COUNT:             "Num. Cells" (total_num_cells)
+ * - Res to ADD, DELETE, LIST: 0, 1, or multiple 6P cells
+ * - Res to SIGNAL:            Payload (arbitrary length)
+ */
+static const sixp_pkt_layout_t response_layouts[] = {
+  /* RC_SUCCESS */
+  LAYOUT(NF, NF, NF, NF, NF, NF, 0, NF, 0, 0, 0, 0),
+  /* RC_EOL */
+  LAYOUT(NF, NF, NF, NF, NF, NF, 0, NF, NF, NF, 0, LEN_CELL_ALIGNED),
+  /* RC_ERR and the other error codes */
+  LAYOUT(NF, NF, NF, NF, NF, NF, NF, NF, NF, NF, 0, LEN_EXACT),
+};
+
+/* A successful Confirmation is a Response without TotalNumCells */
+static const sixp_pkt_layout_t confirmation_success_layout =
+  LAYOUT(NF, NF, NF, NF, NF, NF, 0, NF, NF, 0, 0, 0);
+
+#undef NF
+#undef LAYOUT
 
 /*---------------------------------------------------------------------------*/
-static int32_t
-get_metadata_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
+static const sixp_pkt_layout_t *
+get_layout(sixp_pkt_type_t type, sixp_pkt_code_t code)
 {
   if(type == SIXP_PKT_TYPE_REQUEST) {
-    return 0; /* offset */
+    if(code.value >= SIXP_PKT_CMD_ADD && code.value <= SIXP_PKT_CMD_CLEAR) {
+      return &request_layouts[code.value - SIXP_PKT_CMD_ADD];
+    }
+  } else if(type == SIXP_PKT_TYPE_RESPONSE ||
+            type == SIXP_PKT_TYPE_CONFIRMATION) {
+    if(code.value == SIXP_PKT_RC_SUCCESS &&
+       type == SIXP_PKT_TYPE_CONFIRMATION) {
+      return &confirmation_success_layout;
+    } else if(code.value <= SIXP_PKT_RC_EOL) {
+      return &response_layouts[code.value];
+    } else if(code.value <= SIXP_PKT_RC_ERR_LOCKED) {
+      return &response_layouts[SIXP_PKT_RC_ERR];
+    }
   }
-  return -1;
+  return NULL;
 }
 /*---------------------------------------------------------------------------*/
 static int32_t
-get_cell_options_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
+get_field_offset(sixp_pkt_type_t type, sixp_pkt_code_t code,
+                 sixp_pkt_field_t field)
 {
-  if(type == SIXP_PKT_TYPE_REQUEST &&
-     (code.cmd == SIXP_PKT_CMD_ADD ||
-      code.cmd == SIXP_PKT_CMD_DELETE ||
-      code.cmd == SIXP_PKT_CMD_RELOCATE ||
-      code.cmd == SIXP_PKT_CMD_COUNT ||
-      code.cmd == SIXP_PKT_CMD_LIST)) {
-    return sizeof(sixp_pkt_metadata_t);
-  }
-  return -1;
-}
-/*---------------------------------------------------------------------------*/
-static int32_t
-get_num_cells_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
-{
-  if(type == SIXP_PKT_TYPE_REQUEST &&
-     (code.value == SIXP_PKT_CMD_ADD ||
-      code.value == SIXP_PKT_CMD_DELETE ||
-      code.value == SIXP_PKT_CMD_RELOCATE)) {
-    return sizeof(sixp_pkt_metadata_t) + sizeof(sixp_pkt_cell_options_t);
-  }
+  const sixp_pkt_layout_t *layout = get_layout(type, code);
 
-  return -1;
-}
-/*---------------------------------------------------------------------------*/
-static int32_t
-get_reserved_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
-{
-  if(type == SIXP_PKT_TYPE_REQUEST &&
-     code.value == SIXP_PKT_CMD_LIST) {
-    return sizeof(sixp_pkt_metadata_t) + sizeof(sixp_pkt_cell_options_t);
-  }
-  return -1;
-}
-/*---------------------------------------------------------------------------*/
-static int32_t
-get_offset_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
-{
-  if(type == SIXP_PKT_TYPE_REQUEST &&
-     code.value == SIXP_PKT_CMD_LIST) {
-    return (sizeof(sixp_pkt_metadata_t) +
-            sizeof(sixp_pkt_cell_options_t) +
-            sizeof(sixp_pkt_reserved_t));
+  if(layout == NULL || layout->offset[field] == NO_FIELD) {
+    return -1;
   }
-  return -1;
-}
-/*---------------------------------------------------------------------------*/
-static int32_t
-get_max_num_cells_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
-{
-  if(type == SIXP_PKT_TYPE_REQUEST &&
-     code.value == SIXP_PKT_CMD_LIST) {
-    return (sizeof(sixp_pkt_metadata_t) +
-            sizeof(sixp_pkt_cell_options_t) +
-            sizeof(sixp_pkt_reserved_t) +
-            sizeof(sixp_pkt_offset_t));
-  }
-  return -1;
+  return layout->offset[field];
 }
 /*---------------------------------------------------------------------------*/
-static int32_t
-get_cell_list_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
-{
-  if(type == SIXP_PKT_TYPE_REQUEST && (code.value == SIXP_PKT_CMD_ADD ||
-                                       code.value == SIXP_PKT_CMD_DELETE)) {
-    return (sizeof(sixp_pkt_metadata_t) +
-            sizeof(sixp_pkt_cell_options_t) +
-            sizeof(sixp_pkt_num_cells_t));
-  } else if((type == SIXP_PKT_TYPE_RESPONSE ||
-             type == SIXP_PKT_TYPE_CONFIRMATION) &&
-            (code.value == SIXP_PKT_RC_SUCCESS ||
-             code.value == SIXP_PKT_RC_EOL)) {
-    return 0;
-  }
-  return -1;
-}
-/*---------------------------------------------------------------------------*/
-static int32_t
-get_rel_cell_list_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
+/* Read NumCells of a RELOCATE request, along with the RelCellList offset */
+static int
+get_relocation_fields(sixp_pkt_type_t type, sixp_pkt_code_t code,
+                      const uint8_t *body, uint16_t body_len,
+                      int32_t *offset, sixp_pkt_num_cells_t *num_cells)
 {
-  if(type == SIXP_PKT_TYPE_REQUEST && code.value == SIXP_PKT_CMD_RELOCATE) {
-    return (sizeof(sixp_pkt_metadata_t) +
-            sizeof(sixp_pkt_cell_options_t) +
-            sizeof(sixp_pkt_num_cells_t));
+  const sixp_pkt_layout_t *layout = get_layout(type, code);
+
+  if(layout == NULL || layout->offset[FIELD_REL_CELL_LIST] == NO_FIELD) {
+    LOG_ERR("6P-pkt: packet [type=%u, code=%u] won't have RelCellList\n",
+            type, code.value);
+    return -1;
   }
-  return -1;
-}
-/*---------------------------------------------------------------------------*/
-static int32_t
-get_total_num_cells_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
-{
-  if(type == SIXP_PKT_TYPE_RESPONSE && code.value == SIXP_PKT_RC_SUCCESS) {
-    return 0;
+
+  if(body_len <= layout->offset[FIELD_NUM_CELLS]) {
+    LOG_ERR("6P-pkt: no NumCells field; body is too short\n");
+    return -1;
   }
-  return -1;
-}
-/*---------------------------------------------------------------------------*/
-static int32_t
-get_payload_offset(sixp_pkt_type_t type, sixp_pkt_code_t code)
-{
-  if(type == SIXP_PKT_TYPE_REQUEST && code.value == SIXP_PKT_CMD_SIGNAL) {
-    return sizeof(sixp_pkt_metadata_t);
-  } else if((type == SIXP_PKT_TYPE_RESPONSE ||
-             type == SIXP_PKT_TYPE_CONFIRMATION) &&
-            code.value == SIXP_PKT_RC_SUCCESS) {
-    return 0;
-  }
-  return -1;
+
+  *num_cells = body[layout->offset[FIELD_NUM_CELLS]];
+  *offset = layout->offset[FIELD_REL_CELL_LIST];
+  return 0;
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -204,7 +213,7 @@ sixp_pkt_set_metadata(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_metadata_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_METADATA)) < 0) {
     LOG_ERR("6P-pkt: cannot set metadata [type=%u, code=%u], invalid type\n",
             type, code.value);
     return -1;
@@ -237,7 +246,7 @@ sixp_pkt_get_metadata(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_metadata_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_METADATA)) < 0) {
     LOG_ERR("6P-pkt: cannot get metadata [type=%u, code=%u], invalid type\n",
             type, code.value);
     return -1;
@@ -271,7 +280,7 @@ sixp_pkt_set_cell_options(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_cell_options_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_CELL_OPTIONS)) < 0) {
     LOG_ERR("6P-pkt: cannot set cell_options [type=%u, code=%u], ",
             type, code.value);
     LOG_ERR_("invalid type\n");
@@ -302,7 +311,7 @@ sixp_pkt_get_cell_options(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_cell_options_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_CELL_OPTIONS)) < 0) {
     LOG_ERR("6P-pkt: cannot get cell_options [type=%u, code=%u]",
             type, code.value);
     LOG_ERR_("invalid type\n");
@@ -333,13 +342,19 @@ sixp_pkt_set_num_cells(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_num_cells_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_NUM_CELLS)) < 0) {
     LOG_ERR("6P-pkt: cannot set num_cells; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have NumCells\n",
              type, code.value);
     return -1;
   }
 
+  if(body_len < (offset + sizeof(num_cells))) {
+    LOG_ERR("6P-pkt: cannot set num_cells; body is too short\n");
+    return -1;
+  }
+
+  /* NumCells is an 8-bit unsigned integer */
   memcpy(body + offset, &num_cells, sizeof(uint8_t));
 
   return 0;
@@ -357,7 +372,7 @@ sixp_pkt_get_num_cells(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_num_cells_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_NUM_CELLS)) < 0) {
     LOG_ERR("6P-pkt: cannot get num_cells; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have NumCells\n",
              type, code.value);
@@ -387,7 +402,7 @@ sixp_pkt_set_reserved(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_reserved_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_RESERVED)) < 0) {
     LOG_ERR("6P-pkt: cannot set reserved; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have Reserved\n",
              type, code.value);
@@ -417,13 +432,18 @@ sixp_pkt_get_reserved(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_reserved_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_RESERVED)) < 0) {
     LOG_ERR("6P-pkt: cannot get reserved; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have Reserved\n",
              type, code.value);
     return -1;
   }
 
+  if(body_len < (offset + sizeof(*reserved))) {
+    LOG_ERR("6P-pkt: cannot get reserved; body is too short\n");
+    return -1;
+  }
+
   /* The Reserved field is an 8-bit field */
   memcpy(reserved, body + offset, sizeof(uint8_t));
 
@@ -442,7 +462,7 @@ sixp_pkt_set_offset(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_offset_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_OFFSET)) < 0) {
     LOG_ERR("6P-pkt: cannot set offset; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have Offset\n",
              type, code.value);
@@ -477,7 +497,7 @@ sixp_pkt_get_offset(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_offset_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_OFFSET)) < 0) {
     LOG_ERR("6P-pkt: cannot get offset; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have Offset\n",
              type, code.value);
@@ -511,7 +531,7 @@ sixp_pkt_set_max_num_cells(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_max_num_cells_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_MAX_NUM_CELLS)) < 0) {
     LOG_ERR("6P-pkt: cannot set max_num_cells; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have MaxNumCells\n",
              type, code.value);
@@ -546,7 +566,7 @@ sixp_pkt_get_max_num_cells(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_max_num_cells_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_MAX_NUM_CELLS)) < 0) {
     LOG_ERR("6P-pkt: cannot get max_num_cells; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have MaxNumCells\n",
              type, code.value);
@@ -582,7 +602,7 @@ sixp_pkt_set_cell_list(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_cell_list_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_CELL_LIST)) < 0) {
     LOG_ERR("6P-pkt: cannot set cell_list; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have CellList\n",
              type, code.value);
@@ -617,7 +637,7 @@ sixp_pkt_get_cell_list(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_cell_list_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_CELL_LIST)) < 0) {
     LOG_ERR("6P-pkt: cannot get cell_list; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have CellList\n",
              type, code.value);
@@ -641,6 +661,30 @@ sixp_pkt_get_cell_list(sixp_pkt_type_t type, sixp_pkt_code_t code,
   return 0;
 }
 /*---------------------------------------------------------------------------*/
+uint8_t *
+sixp_pkt_get_cell_list_buf(sixp_pkt_type_t type, sixp_pkt_code_t code,
+                           uint16_t cell_list_len,
+                           uint8_t *body, uint16_t body_len)
+{
+  int32_t offset;
+
+  if(body == NULL ||
+     (offset = get_field_offset(type, code, FIELD_CELL_LIST)) < 0) {
+    LOG_ERR("6P-pkt: cannot get cell_list buffer; ");
+    LOG_ERR_("packet [type=%u, code=%u] won't have CellList\n",
+             type, code.value);
+    return NULL;
+  }
+
+  if(body_len < (offset + cell_list_len) ||
+     (cell_list_len % sizeof(sixp_pkt_cell_t)) != 0) {
+    LOG_ERR("6P-pkt: cannot get cell_list buffer; invalid cell_list_len\n");
+    return NULL;
+  }
+
+  return body + offset;
+}
+/*---------------------------------------------------------------------------*/
 int
 sixp_pkt_set_rel_cell_list(sixp_pkt_type_t type, sixp_pkt_code_t code,
                            const uint8_t *rel_cell_list,
@@ -656,15 +700,9 @@ sixp_pkt_set_rel_cell_list(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if(sixp_pkt_get_num_cells(type, code, &num_cells, body, body_len) < 0) {
-    LOG_ERR("6P-pkt: cannot set rel_cell_list; no NumCells field\n");
-    return -1;
-  }
-
-  if((offset = get_rel_cell_list_offset(type, code)) < 0) {
-    LOG_ERR("6P-pkt: cannot set rel_cell_list; ");
-    LOG_ERR_("packet [type=%u, code=%u] won't have RelCellList\n",
-             type, code.value);
+  if(get_relocation_fields(type, code, body, body_len,
+                           &offset, &num_cells) < 0) {
+    LOG_ERR("6P-pkt: cannot set rel_cell_list\n");
     return -1;
   }
 
@@ -701,15 +739,9 @@ sixp_pkt_get_rel_cell_list(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if(sixp_pkt_get_num_cells(type, code, &num_cells, body, body_len) < 0) {
-    LOG_ERR("6P-pkt: cannot get rel_cell_list; no NumCells field\n");
-    return -1;
-  }
-
-  if((offset = get_rel_cell_list_offset(type, code)) < 0) {
-    LOG_ERR("6P-pkt: cannot get rel_cell_list; ");
-    LOG_ERR_("packet [type=%u, code=%u] won't have RelCellList\n",
-             type, code.value);
+  if(get_relocation_fields(type, code, body, body_len,
+                           &offset, &num_cells) < 0) {
+    LOG_ERR("6P-pkt: cannot get rel_cell_list\n");
     return -1;
   }
 
@@ -745,15 +777,9 @@ sixp_pkt_set_cand_cell_list(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if(sixp_pkt_get_num_cells(type, code, &num_cells, body, body_len) < 0) {
-    LOG_ERR("6P-pkt: cannot set cand_cell_list; no NumCells field\n");
-    return -1;
-  }
-
-  if((offset = get_rel_cell_list_offset(type, code)) < 0) {
-    LOG_ERR("6P-pkt: cannot set cand_cell_list; ");
-    LOG_ERR_("packet [type=%u, code=%u] won't have RelCellList\n",
-             type, code.value);
+  if(get_relocation_fields(type, code, body, body_len,
+                           &offset, &num_cells) < 0) {
+    LOG_ERR("6P-pkt: cannot set cand_cell_list\n");
     return -1;
   }
 
@@ -786,15 +812,9 @@ sixp_pkt_get_cand_cell_list(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if(sixp_pkt_get_num_cells(type, code, &num_cells, body, body_len) < 0) {
-    LOG_ERR("6P-pkt: cannot get cand_cell_list; no NumCells field\n");
-    return -1;
-  }
-
-  if((offset = get_rel_cell_list_offset(type, code)) < 0) {
-    LOG_ERR("6P-pkt: cannot get cand_cell_list; ");
-    LOG_ERR_("packet [type=%u, code=%u] won't have RelCellList\n",
-             type, code.value);
+  if(get_relocation_fields(type, code, body, body_len,
+                           &offset, &num_cells) < 0) {
+    LOG_ERR("6P-pkt: cannot get cand_cell_list\n");
     return -1;
   }
 
@@ -829,13 +849,18 @@ sixp_pkt_set_total_num_cells(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_total_num_cells_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_TOTAL_NUM_CELLS)) < 0) {
     LOG_ERR("6P-pkt: cannot set total_num_cells; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have TotalNumCells\n",
              type, code.value);
     return -1;
   }
 
+  if(body_len < (offset + sizeof(total_num_cells))) {
+    LOG_ERR("6P-pkt: cannot set total_num_cells; body is too short\n");
+    return -1;
+  }
+
   /*
    * TotalNumCells for 6P Response is a 16-bit unsigned integer, little-endian.
    */
@@ -857,7 +882,7 @@ sixp_pkt_get_total_num_cells(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_total_num_cells_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_TOTAL_NUM_CELLS)) < 0) {
     LOG_ERR("6P-pkt: cannot get num_cells; ");
     LOG_ERR_("packet [type=%u, code=%u] won't have TotalNumCells\n",
              type, code.value);
@@ -870,8 +895,8 @@ sixp_pkt_get_total_num_cells(sixp_pkt_type_t type, sixp_pkt_code_t code,
   }
 
   /* TotalNumCells is a 16-bit unsigned integer, little-endian. */
-  *total_num_cells = body[0];
-  *total_num_cells += ((uint16_t)body[1]) << 8;
+  *total_num_cells = body[offset];
+  *total_num_cells += ((uint16_t)body[offset + 1]) << 8;
 
   return 0;
 }
@@ -888,7 +913,7 @@ sixp_pkt_set_payload(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_payload_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_PAYLOAD)) < 0) {
     LOG_ERR("6P-pkt: cannot set payload [type=%u, code=%u], invalid type\n",
             type, code.value);
     return -1;
@@ -921,13 +946,16 @@ sixp_pkt_get_payload(sixp_pkt_type_t type, sixp_pkt_code_t code,
     return -1;
   }
 
-  if((offset = get_payload_offset(type, code)) < 0) {
+  if((offset = get_field_offset(type, code, FIELD_PAYLOAD)) < 0) {
     LOG_ERR("6P-pkt: cannot get payload [type=%u, code=%u], invalid type\n",
             type, code.value);
     return -1;
   }
 
-  if((body_len - offset) > buf_len) {
+  if(body_len < offset) {
+    LOG_ERR("6P-pkt: cannot get payload; body is too short\n");
+    return -1;
+  } else if((body_len - offset) > buf_len) {
     LOG_ERR("6P-pkt: cannot get payload [type=%u, code=%u], ",
             type, code.value);
     LOG_ERR_("buf_len is too short\n");
@@ -938,7 +966,7 @@ sixp_pkt_get_payload(sixp_pkt_type_t type, sixp_pkt_code_t code,
    * Copy the content in the Payload field as it is since 6P has no idea about
    * the internal structure of the field.
    */
-  memcpy(buf, body + offset, buf_len);
+  memcpy(buf, body + offset, body_len - offset);
 
   return 0;
 }
@@ -947,6 +975,8 @@ int
 sixp_pkt_parse(const uint8_t *buf, uint16_t len,
                sixp_pkt_t *pkt)
 {
+  const sixp_pkt_layout_t *layout;
+
   assert(buf != NULL && pkt != NULL);
   if(buf == NULL || pkt == NULL) {
     LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid argument\n");
@@ -980,99 +1010,17 @@ sixp_pkt_parse(const uint8_t *buf, uint16_t len,
            pkt->type, pkt->code.value, len);
 
   /* the rest is message body called "Other Fields" */
-  if(pkt->type == SIXP_PKT_TYPE_REQUEST) {
-    switch(pkt->code.cmd) {
-      case SIXP_PKT_CMD_ADD:
-      case SIXP_PKT_CMD_DELETE:
-        /* Add and Delete has the same request format */
-        if(len < (sizeof(sixp_pkt_metadata_t) +
-                  sizeof(sixp_pkt_cell_options_t) +
-                  sizeof(sixp_pkt_num_cells_t)) ||
-           (len % sizeof(uint32_t)) != 0) {
-          LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid length\n");
-          return -1;
-        }
-        break;
-      case SIXP_PKT_CMD_RELOCATE:
-        if(len < (sizeof(sixp_pkt_metadata_t) +
-                  sizeof(sixp_pkt_cell_options_t) +
-                  sizeof(sixp_pkt_num_cells_t)) ||
-           (len % sizeof(uint32_t)) != 0) {
-          LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid length\n");
-          return -1;
-        }
-        break;
-      case SIXP_PKT_CMD_COUNT:
-        if(len != (sizeof(sixp_pkt_metadata_t) +
-                   sizeof(sixp_pkt_cell_options_t))) {
-          LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid length\n");
-          return -1;
-        }
-        break;
-      case SIXP_PKT_CMD_LIST:
-        if(len != (sizeof(sixp_pkt_metadata_t) +
-                   sizeof(sixp_pkt_cell_options_t) +
-                   sizeof(sixp_pkt_reserved_t) +
-                   sizeof(sixp_pkt_offset_t) +
-                   sizeof(sixp_pkt_max_num_cells_t))) {
-          LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid length\n");
-          return -1;
-        }
-        break;
-      case SIXP_PKT_CMD_SIGNAL:
-        if(len < sizeof(sixp_pkt_metadata_t)) {
-          LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid length\n");
-          return -1;
-        }
-        break;
-      case SIXP_PKT_CMD_CLEAR:
-        if(len != sizeof(sixp_pkt_metadata_t)) {
-          LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid length\n");
-          return -1;
-        }
-        break;
-      default:
-        LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of unsupported cmd\n");
-        return -1;
-    }
-  } else if(pkt->type == SIXP_PKT_TYPE_RESPONSE ||
-            pkt->type == SIXP_PKT_TYPE_CONFIRMATION) {
-    switch(pkt->code.rc) {
-      case SIXP_PKT_RC_SUCCESS:
-        /*
-         * The "Other Field" contains
-         * - Res to CLEAR:             Empty (length 0)
-         * - Res to STATUS:            "Num. Cells" (total_num_cells)
-         * - Res to ADD, DELETE, LIST: 0, 1, or multiple 6P cells
-         * - Res to SIGNAL:            Payload (arbitrary length)
-         */
-        /* we accept any length because of SIGNAL */
-        break;
-      case SIXP_PKT_RC_EOL:
-        if((len % sizeof(uint32_t)) != 0) {
-          LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid length\n");
-          return -1;
-        }
-        break;
-      case SIXP_PKT_RC_ERR:
-      case SIXP_PKT_RC_RESET:
-      case SIXP_PKT_RC_ERR_VERSION:
-      case SIXP_PKT_RC_ERR_SFID:
-      case SIXP_PKT_RC_ERR_SEQNUM:
-      case SIXP_PKT_RC_ERR_CELLLIST:
-      case SIXP_PKT_RC_ERR_BUSY:
-      case SIXP_PKT_RC_ERR_LOCKED:
-        if(len != 0) {
-          LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid length\n");
-          return -1;
-        }
-        break;
-      default:
-        LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of unsupported code\n");
-        return -1;
-    }
-  } else {
-    LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of unsupported type\n");
+  if((layout = get_layout(pkt->type, pkt->code)) == NULL) {
+    LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of unsupported ");
+    LOG_ERR_("type or code\n");
+    return -1;
+  }
+
+  if(len < layout->min_len ||
+     ((layout->len_flags & LEN_EXACT) && len != layout->min_len) ||
+     ((layout->len_flags & LEN_CELL_ALIGNED) &&
+      ((len - layout->min_len) % sizeof(sixp_pkt_cell_t)) != 0)) {
+    LOG_ERR("6P-pkt: sixp_pkt_parse() fails because of invalid length\n");
     return -1;
   }
 
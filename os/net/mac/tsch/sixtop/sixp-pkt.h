@@ -56,6 +56,11 @@ typedef uint16_t sixp_pkt_offset_t;
 typedef uint32_t sixp_pkt_cell_t;
 typedef uint16_t sixp_pkt_total_num_cells_t;
 
+/**
+ * \brief The length of a 6P cell in a CellList
+ */
+#define SIXP_PKT_CELL_LEN  sizeof(sixp_pkt_cell_t)
+
 /**
  * \brief 6P Message Types
  */
@@ -317,6 +322,54 @@ int sixp_pkt_get_cell_list(sixp_pkt_type_t type, sixp_pkt_code_t code,
                            sixp_pkt_offset_t *cell_list_len,
                            const uint8_t *body, uint16_t body_len);
 
+/**
+ * \brief Get a writable pointer to CellList in "Other Fields" of 6P packet
+ * \param type 6P Message Type
+ * \param code 6P Command Identifier or Return Code
+ * \param cell_list_len The length of CellList to be written, in octets
+ * \param body The pointer to buffer pointing to "Other Fields"
+ * \param body_len The length of body, typically "Other Fields" length
+ * \return The pointer to CellList, or NULL if the packet won't have CellList
+ * or body is too short
+ *
+ * Cells can be encoded in place with sixp_pkt_write_cell(), so that a
+ * CellList doesn't need to be built in a separate buffer and copied.
+ */
+uint8_t *sixp_pkt_get_cell_list_buf(sixp_pkt_type_t type, sixp_pkt_code_t code,
+                                    uint16_t cell_list_len,
+                                    uint8_t *body, uint16_t body_len);
+
+/**
+ * \brief Encode a cell of CellList, RelCellList, or CandCellList
+ * \param cell The pointer to the cell, SIXP_PKT_CELL_LEN octets
+ * \param slot_offset slotOffset of the cell
+ * \param channel_offset channelOffset of the cell
+ */
+static inline void
+sixp_pkt_write_cell(uint8_t *cell,
+                    uint16_t slot_offset, uint16_t channel_offset)
+{
+  /* Both fields are 16-bit unsigned integers, little-endian */
+  cell[0] = slot_offset & 0xff;
+  cell[1] = slot_offset >> 8;
+  cell[2] = channel_offset & 0xff;
+  cell[3] = channel_offset >> 8;
+}
+
+/**
+ * \brief Decode a cell of CellList, RelCellList, or CandCellList
+ * \param cell The pointer to the cell, SIXP_PKT_CELL_LEN octets
+ * \param slot_offset The pointer to store slotOffset in
+ * \param channel_offset The pointer to store channelOffset in
+ */
+static inline void
+sixp_pkt_read_cell(const uint8_t *cell,
+                   uint16_t *slot_offset, uint16_t *channel_offset)
+{
+  *slot_offset = cell[0] | ((uint16_t)cell[1] << 8);
+  *channel_offset = cell[2] | ((uint16_t)cell[3] << 8);
+}
+
 /**
  * \brief Write RelCellList in "Other Fields" of 6P packet
  * \note "offset" is specified by index in RelCellList
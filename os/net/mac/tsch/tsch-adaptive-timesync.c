@@ -60,6 +60,12 @@ static uint8_t timesync_entry_count;
 static uint32_t asn_since_last_learning;
 /* The last neighbor used for timesync */
 struct tsch_neighbor *last_timesource_neighbor;
+#if TSCH_ADAPTIVE_KEEPALIVE
+/* Drift corrections applied since last learning, in absolute value */
+static uint32_t residual_ticks;
+/* Moving average of the drift left after compensation, in ppm * 256 */
+static int32_t residual_drift_ppm;
+#endif /* TSCH_ADAPTIVE_KEEPALIVE */
 
 /* Units in which drift is stored: ppm * 256 */
 #define TSCH_DRIFT_UNIT (1000L * 1000 * 256)
@@ -86,9 +92,11 @@ timesync_entry_add(int32_t val)
   if(timesync_entry_count < NUM_TIMESYNC_ENTRIES) {
     timesync_entry_count++;
   } else {
+#if !TSCH_ADAPTIVE_KEEPALIVE
     /* We now have accurate drift compensation.
      * Increase keep-alive timeout. */
     tsch_set_ka_timeout(TSCH_MAX_KEEPALIVE_TIMEOUT);
+#endif /* !TSCH_ADAPTIVE_KEEPALIVE */
   }
   pos = (pos + 1) % NUM_TIMESYNC_ENTRIES;
 
@@ -99,6 +107,43 @@ timesync_entry_add(int32_t val)
   return val / timesync_entry_count;
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_ADAPTIVE_KEEPALIVE
+/* Pick the longest keep-alive timeout over which the drift left after
+ * compensation stays within a quarter of the Rx guard time, i.e. half of the
+ * margin on either side of the expected Rx time. The timeout is at most
+ * doubled at each step, so that it only grows while the estimate holds. */
+static void
+adapt_ka_timeout(void)
+{
+  uint32_t current = tsch_get_ka_timeout();
+  uint32_t timeout = TSCH_MAX_KEEPALIVE_TIMEOUT;
+
+  if(current == 0) {
+    /* Keep-alives are disabled */
+    return;
+  }
+
+  if(residual_drift_ppm > 0) {
+    /* Time for the residual drift to reach the margin, in 1/256 s. This runs
+     * in the slot operation interrupt, so stick to 32-bit arithmetic: the
+     * margin is below 2^14 us and TSCH_DRIFT_UNIT / 10^6 is 256 */
+    uint32_t margin_us = tsch_timing_us[tsch_ts_rx_wait] / 4;
+    uint32_t time_256th = margin_us * (TSCH_DRIFT_UNIT / 1000000) * 256
+      / (uint32_t)residual_drift_ppm;
+    if(time_256th < (uint32_t)TSCH_MAX_KEEPALIVE_TIMEOUT * 256 / CLOCK_SECOND) {
+      timeout = time_256th * CLOCK_SECOND / 256;
+    }
+  }
+  timeout = MIN(timeout, 2 * current);
+  timeout = MIN(timeout, TSCH_MAX_KEEPALIVE_TIMEOUT);
+  timeout = MAX(timeout, TSCH_KEEPALIVE_TIMEOUT);
+
+  if(timeout != current) {
+    tsch_set_ka_timeout(timeout);
+  }
+}
+#endif /* TSCH_ADAPTIVE_KEEPALIVE */
+/*---------------------------------------------------------------------------*/
 /* Learn the neighbor drift rate at ppm */
 static void
 timesync_learn_drift_ticks(uint32_t time_delta_asn, int32_t drift_ticks)
@@ -110,6 +155,23 @@ timesync_learn_drift_ticks(uint32_t time_delta_asn, int32_t drift_ticks)
 
   drift_ppm = timesync_entry_add(last_drift_ppm);
 
+#if TSCH_ADAPTIVE_KEEPALIVE
+  {
+    int32_t last_residual_ppm = (int32_t)(((int64_t)residual_ticks * TSCH_DRIFT_UNIT) / time_delta_ticks);
+    if(timesync_entry_count == 1) {
+      residual_drift_ppm = last_residual_ppm;
+    } else {
+      residual_drift_ppm += (last_residual_ppm - residual_drift_ppm) / 4;
+    }
+    residual_ticks = 0;
+    if(timesync_entry_count >= NUM_TIMESYNC_ENTRIES) {
+      /* Drift compensation is accurate, the residual tells how long we can
+       * go without synchronization */
+      adapt_ka_timeout();
+    }
+  }
+#endif /* TSCH_ADAPTIVE_KEEPALIVE */
+
   TSCH_LOG_ADD(tsch_log_message,
       snprintf(log->message, sizeof(log->message),
           "drift %ld ppm (min/max delta seen: %"PRId32"/%"PRId32")",
@@ -125,10 +187,24 @@ tsch_timesync_update(struct tsch_neighbor *n, uint16_t time_delta_asn, int32_t d
    * or the timedelta is not too small, as smaller timedelta
    * means proportionally larger measurement error. */
   if(last_timesource_neighbor != n) {
-    tsch_adaptive_timesync_reset();
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+    if(last_timesource_neighbor != NULL) {
+      /* Switched to another time source of the same network: our drift
+       * w.r.t. it is close to the one we learned, keep it and only restart
+       * the current learning interval */
+      compensated_ticks = 0;
+      asn_since_last_learning = 0;
+    } else
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+    {
+      tsch_adaptive_timesync_reset();
+    }
     last_timesource_neighbor = n;
   } else {
     asn_since_last_learning += time_delta_asn;
+#if TSCH_ADAPTIVE_KEEPALIVE
+    residual_ticks += ABS(drift_correction);
+#endif /* TSCH_ADAPTIVE_KEEPALIVE */
     if(asn_since_last_learning >= 4 * TSCH_SLOTS_PER_SECOND) {
       timesync_learn_drift_ticks(asn_since_last_learning, drift_correction);
       compensated_ticks = 0;
@@ -200,6 +276,10 @@ tsch_adaptive_timesync_reset(void)
   timesync_entry_count = 0;
   compensated_ticks = 0;
   asn_since_last_learning = 0;
+#if TSCH_ADAPTIVE_KEEPALIVE
+  residual_ticks = 0;
+  residual_drift_ppm = 0;
+#endif /* TSCH_ADAPTIVE_KEEPALIVE */
 }
 /*---------------------------------------------------------------------------*/
 #else /* TSCH_ADAPTIVE_TIMESYNC */
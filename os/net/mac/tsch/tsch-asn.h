@@ -56,6 +56,13 @@ struct tsch_asn_divisor_t {
   uint16_t asn_ms1b_remainder; /* Remainder of the operation 0x100000000 / val */
 };
 
+/** \brief An ASN modulo that is updated incrementally as the ASN advances */
+struct tsch_asn_mod_cache_t {
+  struct tsch_asn_t asn; /* ASN the modulo was last computed for */
+  uint16_t div; /* Divisor it was computed with, 0 when invalid */
+  uint16_t mod; /* The result */
+};
+
 /************ Macros **********/
 
 /** \brief Initialize ASN */
@@ -105,5 +112,46 @@ struct tsch_asn_divisor_t {
 #define TSCH_ASN_DEVISION(asn, div) \
   (uint16_t)((uint16_t)((asn).ls4b) / (div).val)
 
+/** \brief Invalidate a struct tsch_asn_mod_cache_t */
+#define TSCH_ASN_MOD_CACHE_INIT(cache) do { \
+    (cache).div = 0; \
+} while(0);
+
+/************ Functions *******/
+
+/**
+ * \brief Returns the same as TSCH_ASN_MOD, but reuses the result of the
+ * previous call when the ASN has moved forward by less than 2^16 slots
+ * since, which then costs at most a 16-bit modulo instead of a 40-bit one
+ * \param asn The ASN
+ * \param div The divisor
+ * \param cache Where the previous result is kept, one per divisor
+ * \return The ASN modulo the divisor
+ */
+static inline uint16_t
+tsch_asn_mod_incremental(const struct tsch_asn_t *asn,
+                         const struct tsch_asn_divisor_t *div,
+                         struct tsch_asn_mod_cache_t *cache)
+{
+  uint32_t delta = TSCH_ASN_DIFF(*asn, cache->asn);
+  if(cache->div != div->val || asn->ms1b != cache->asn.ms1b || delta > 0xffff) {
+    cache->mod = TSCH_ASN_MOD(*asn, *div);
+    cache->div = div->val;
+  } else {
+    uint16_t delta16 = (uint16_t)delta;
+    uint32_t mod;
+    if(delta16 >= div->val) {
+      delta16 %= div->val;
+    }
+    mod = (uint32_t)cache->mod + delta16;
+    if(mod >= div->val) {
+      mod -= div->val;
+    }
+    cache->mod = (uint16_t)mod;
+  }
+  cache->asn = *asn;
+  return cache->mod;
+}
+
 #endif /* __TSCH_ASN_H__ */
 /** @} */
@@ -64,6 +64,39 @@
 #define TSCH_MAX_KEEPALIVE_TIMEOUT (60 * CLOCK_SECOND)
 #endif
 
+/* With TSCH_ADAPTIVE_TIMESYNC enabled: instead of switching to
+ * TSCH_MAX_KEEPALIVE_TIMEOUT once drift compensation is accurate, stretch the
+ * keep-alive timeout only as far as the drift left after compensation allows,
+ * and tighten it back to TSCH_KEEPALIVE_TIMEOUT when a keep-alive is not
+ * acknowledged. The EB period is stretched in the same proportion, up to
+ * TSCH_ADAPTIVE_MAX_EB_PERIOD. */
+#ifdef TSCH_CONF_ADAPTIVE_KEEPALIVE
+#define TSCH_ADAPTIVE_KEEPALIVE (TSCH_ADAPTIVE_TIMESYNC && TSCH_CONF_ADAPTIVE_KEEPALIVE)
+#else
+#define TSCH_ADAPTIVE_KEEPALIVE 0
+#endif
+
+/* Keep track of the clock offset of every neighbor we hear from whose join
+ * priority is lower than ours. When the time source is lost, fail over to
+ * the best of them (lowest ETX) without leaving the PAN, and carry the
+ * learned drift over to the new time source. The routing layer is told
+ * about the lost time source via TSCH_CALLBACK_TIME_SOURCE_FAILOVER. */
+#ifdef TSCH_CONF_WITH_BACKUP_TIME_SOURCES
+#define TSCH_WITH_BACKUP_TIME_SOURCES TSCH_CONF_WITH_BACKUP_TIME_SOURCES
+#else
+#define TSCH_WITH_BACKUP_TIME_SOURCES 0
+#endif
+
+/* Max number of neighbors tracked as candidate backup time sources. EBs
+ * from further neighbors closer to the root are ignored until a candidate
+ * is garbage-collected, i.e. has not given us timing for the max keep-alive
+ * timeout. */
+#ifdef TSCH_CONF_MAX_BACKUP_TIME_SOURCES
+#define TSCH_MAX_BACKUP_TIME_SOURCES TSCH_CONF_MAX_BACKUP_TIME_SOURCES
+#else
+#define TSCH_MAX_BACKUP_TIME_SOURCES 3
+#endif
+
 /* Max time without synchronization before leaving the PAN */
 #ifdef TSCH_CONF_DESYNC_THRESHOLD
 #define TSCH_DESYNC_THRESHOLD TSCH_CONF_DESYNC_THRESHOLD
@@ -91,6 +124,15 @@
 #define TSCH_MAX_EB_PERIOD (16 * CLOCK_SECOND)
 #endif
 
+/* With TSCH_ADAPTIVE_KEEPALIVE: the max period between two consecutive EBs
+ * of a node that keeps in sync with its time source at the longest
+ * keep-alive timeout. The coordinator never stretches its EB period. */
+#ifdef TSCH_CONF_ADAPTIVE_MAX_EB_PERIOD
+#define TSCH_ADAPTIVE_MAX_EB_PERIOD TSCH_CONF_ADAPTIVE_MAX_EB_PERIOD
+#else
+#define TSCH_ADAPTIVE_MAX_EB_PERIOD (4 * TSCH_MAX_EB_PERIOD)
+#endif
+
 /* Use SFD timestamp for synchronization? By default we merely rely on rtimer and busy wait
  * until SFD is high, which we found to provide greater accuracy on JN516x and CC2420.
  * Note: for association, however, we always use SFD timestamp to know the time of arrival
@@ -225,6 +267,28 @@
 #define TSCH_CHANNEL_SCAN_DURATION CLOCK_SECOND
 #endif
 
+/* Minimum time to scan each channel. Every frame heard on the current
+ * channel extends the scan of that channel by this duration, up to
+ * TSCH_CHANNEL_SCAN_DURATION, so that silent channels are left early. */
+#ifdef TSCH_CONF_CHANNEL_SCAN_MIN_DURATION
+#define TSCH_CHANNEL_SCAN_MIN_DURATION TSCH_CONF_CHANNEL_SCAN_MIN_DURATION
+#else
+#define TSCH_CHANNEL_SCAN_MIN_DURATION TSCH_CHANNEL_SCAN_DURATION
+#endif
+
+/* When scanning, keep collecting EBs for this long after the first valid
+ * one, then associate with the best of them (lowest join priority, then
+ * highest RSSI). An EB from the coordinator ends the collection early.
+ * 0 to associate with the first valid EB. The chosen EB timestamp is used for
+ * synchronization, so the window plus 2 seconds must be shorter than half the
+ * rtimer wraparound time (about 18 hours for a 32-bit rtimer at 32768 Hz).
+ * Platforms with a 16-bit rtimer cannot use this. */
+#ifdef TSCH_CONF_SCAN_COLLECT_DURATION
+#define TSCH_SCAN_COLLECT_DURATION TSCH_CONF_SCAN_COLLECT_DURATION
+#else
+#define TSCH_SCAN_COLLECT_DURATION 0
+#endif
+
 /* TSCH EB: include timeslot timing Information Element? */
 #ifdef TSCH_PACKET_CONF_EB_WITH_TIMESLOT_TIMING
 #define TSCH_PACKET_EB_WITH_TIMESLOT_TIMING TSCH_PACKET_CONF_EB_WITH_TIMESLOT_TIMING
@@ -246,6 +310,16 @@
 #define TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK 0
 #endif
 
+/* TSCH EB: keep the last EB built as a template, and reuse it for the next
+ * EBs as long as the settings it depends on (schedule, hopping sequence,
+ * security, PAN ID) are unchanged. ASN and join priority are patched in place
+ * at send time anyway. Costs TSCH_PACKET_MAX_LEN bytes of RAM. */
+#ifdef TSCH_PACKET_CONF_EB_TEMPLATE
+#define TSCH_PACKET_EB_TEMPLATE TSCH_PACKET_CONF_EB_TEMPLATE
+#else
+#define TSCH_PACKET_EB_TEMPLATE 1
+#endif
+
 /******** Configuration: queues  *******/
 
 /* Size of the ring buffer storing dequeued outgoing packets (only an array of pointers).
@@ -280,6 +354,28 @@
 #define TSCH_MAX_INCOMING_PACKETS 4
 #endif
 
+/* Back-pressure on the incoming packet ringbuf. When it holds at least this
+ * many packets, EACKs carry the frame pending bit, telling the sender to
+ * back off and not to start a burst. When it is full, frames are still
+ * received (in a scratch buffer), and NACKed with the frame pending bit set.
+ * Senders count only such NACKs as failed transmissions (MAC_TX_NOACK).
+ * Set to 0 to disable, in which case TSCH does not listen at all when the
+ * ringbuf is full. */
+#ifdef TSCH_CONF_INPUT_BACKPRESSURE_THRESHOLD
+#define TSCH_INPUT_BACKPRESSURE_THRESHOLD TSCH_CONF_INPUT_BACKPRESSURE_THRESHOLD
+#else
+#define TSCH_INPUT_BACKPRESSURE_THRESHOLD (TSCH_MAX_INCOMING_PACKETS - 1)
+#endif
+
+/* Pass incoming data frames to upper layers by referencing them in place
+ * (see packetbuf_reference) rather than copying them to the packetbuf.
+ * 6LoWPAN then decompresses directly from the TSCH input buffer. */
+#ifdef TSCH_CONF_WITH_ZERO_COPY_INPUT
+#define TSCH_WITH_ZERO_COPY_INPUT TSCH_CONF_WITH_ZERO_COPY_INPUT
+#else
+#define TSCH_WITH_ZERO_COPY_INPUT 1
+#endif
+
 /* The maximum number of outgoing packets towards each neighbor
  * Must be power of two to enable atomic ringbuf operations.
  * Note: the total number of outgoing packets in the system (for
@@ -357,7 +453,7 @@
 #ifdef TSCH_CONF_WITH_SIXTOP
 #define TSCH_WITH_SIXTOP TSCH_CONF_WITH_SIXTOP
 #else
-#define TSCH_WITH_SIXTOP 0
+#define TSCH_WITH_SIXTOP (BUILD_WITH_MSF)
 #endif
 
 /* A custom feature allowing upper layers to assign packets to
@@ -368,6 +464,14 @@
 #define TSCH_WITH_LINK_SELECTOR (BUILD_WITH_ORCHESTRA)
 #endif /* TSCH_CONF_WITH_LINK_SELECTOR */
 
+/* A slotframe exempt from the link selector: any packet may use its dedicated
+ * Tx links to the packet's destination. Used for cells negotiated with 6P. */
+#ifdef TSCH_CONF_LINK_SELECTOR_OPEN_SLOTFRAME
+#define TSCH_LINK_SELECTOR_OPEN_SLOTFRAME TSCH_CONF_LINK_SELECTOR_OPEN_SLOTFRAME
+#else /* TSCH_CONF_LINK_SELECTOR_OPEN_SLOTFRAME */
+#define TSCH_LINK_SELECTOR_OPEN_SLOTFRAME 0xffff
+#endif /* TSCH_CONF_LINK_SELECTOR_OPEN_SLOTFRAME */
+
 /* Configurable link comparator in case multiple links are scheduled at the same slot */
 #ifdef TSCH_CONF_LINK_COMPARATOR
 #define TSCH_LINK_COMPARATOR TSCH_CONF_LINK_COMPARATOR
@@ -73,6 +73,20 @@ static struct packetbuf_attr eackbuf_attrs[PACKETBUF_NUM_ATTRS];
 /* The offset of the frame pending bit flag within the first byte of FCF */
 #define IEEE802154_FRAME_PENDING_BIT_OFFSET 4
 
+/* The EB template can only be reused as-is if the EB has no sequence number
+ * (suppressed for broadcast frames from IEEE 802.15.4-2015 onwards) */
+#define TSCH_PACKET_WITH_EB_TEMPLATE \
+  (TSCH_PACKET_EB_TEMPLATE && FRAME802154_VERSION >= FRAME802154_IEEE802154_2015)
+
+#if TSCH_PACKET_WITH_EB_TEMPLATE
+/* The last EB created, as output by the framer (header and payload) */
+static uint8_t eb_template[TSCH_PACKET_MAX_LEN];
+static uint8_t eb_template_len;
+static uint8_t eb_template_hdr_len;
+static uint8_t eb_template_sync_ie_offset;
+static uint8_t eb_template_valid;
+#endif /* TSCH_PACKET_WITH_EB_TEMPLATE */
+
 /*---------------------------------------------------------------------------*/
 void
 tsch_packet_eackbuf_set_attr(uint8_t type, const packetbuf_attr_t val)
@@ -215,6 +229,29 @@ tsch_packet_parse_eack(const uint8_t *buf, int buf_size,
   return curr_len;
 }
 /*---------------------------------------------------------------------------*/
+/* Set the packetbuf attributes of an EB */
+static void
+eb_set_packetbuf_attr(void)
+{
+  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_BEACONFRAME);
+  packetbuf_set_attr(PACKETBUF_ATTR_MAC_METADATA, 1);
+
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &tsch_eb_address);
+
+#if LLSEC802154_ENABLED
+  tsch_security_set_packetbuf_attr(FRAME802154_BEACONFRAME);
+#endif /* LLSEC802154_ENABLED */
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_packet_invalidate_eb(void)
+{
+#if TSCH_PACKET_WITH_EB_TEMPLATE
+  eb_template_valid = 0;
+#endif /* TSCH_PACKET_WITH_EB_TEMPLATE */
+}
+/*---------------------------------------------------------------------------*/
 /* Create an EB packet */
 int
 tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
@@ -226,6 +263,28 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
 
   packetbuf_clear();
 
+#if TSCH_PACKET_WITH_EB_TEMPLATE
+  if(eb_template_valid) {
+    /* Restore header and payload from the template. ASN and join priority
+     * are updated by slot operation, right before transmission. */
+    eb_set_packetbuf_attr();
+    memcpy(packetbuf_dataptr(), eb_template + eb_template_hdr_len,
+           eb_template_len - eb_template_hdr_len);
+    packetbuf_set_datalen(eb_template_len - eb_template_hdr_len);
+    if(!packetbuf_hdralloc(eb_template_hdr_len)) {
+      return -1;
+    }
+    memcpy(packetbuf_hdrptr(), eb_template, eb_template_hdr_len);
+    if(hdr_len != NULL) {
+      *hdr_len = eb_template_hdr_len;
+    }
+    if(tsch_sync_ie_offset != NULL) {
+      *tsch_sync_ie_offset = eb_template_sync_ie_offset;
+    }
+    return packetbuf_totlen();
+  }
+#endif /* TSCH_PACKET_WITH_EB_TEMPLATE */
+
   /* Prepare Information Elements for inclusion in the EB */
   memset(&ies, 0, sizeof(ies));
 
@@ -342,15 +401,7 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
     return -1;
   }
 
-  packetbuf_set_attr(PACKETBUF_ATTR_FRAME_TYPE, FRAME802154_BEACONFRAME);
-  packetbuf_set_attr(PACKETBUF_ATTR_MAC_METADATA, 1);
-
-  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &linkaddr_node_addr);
-  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &tsch_eb_address);
-
-#if LLSEC802154_ENABLED
-  tsch_security_set_packetbuf_attr(FRAME802154_BEACONFRAME);
-#endif /* LLSEC802154_ENABLED */
+  eb_set_packetbuf_attr();
 
   if(NETSTACK_FRAMER.create() < 0) {
     return -1;
@@ -369,6 +420,16 @@ tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_offset)
     *tsch_sync_ie_offset = packetbuf_hdrlen() + payload_ie_hdr_len;
   }
 
+#if TSCH_PACKET_WITH_EB_TEMPLATE
+  if(packetbuf_totlen() <= sizeof(eb_template)) {
+    eb_template_len = packetbuf_totlen();
+    eb_template_hdr_len = packetbuf_hdrlen();
+    eb_template_sync_ie_offset = packetbuf_hdrlen() + payload_ie_hdr_len;
+    memcpy(eb_template, packetbuf_hdrptr(), eb_template_len);
+    eb_template_valid = 1;
+  }
+#endif /* TSCH_PACKET_WITH_EB_TEMPLATE */
+
   return packetbuf_totlen();
 }
 /*---------------------------------------------------------------------------*/
@@ -80,6 +80,12 @@ int tsch_packet_parse_eack(const uint8_t *buf, int buf_size,
  * \return The total length of the EB
  */
 int tsch_packet_create_eb(uint8_t *hdr_len, uint8_t *tsch_sync_ie_ptr);
+/**
+ * \brief Drop the cached EB template, if any, so that the next call to
+ * tsch_packet_create_eb rebuilds the EB from scratch. To be called whenever
+ * any of the EB contents (other than ASN and join priority) may have changed.
+ */
+void tsch_packet_invalidate_eb(void);
 /**
  * \brief Update ASN in EB packet
  * \param buf The buffer that contains the EB
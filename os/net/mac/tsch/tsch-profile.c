@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         TSCH slot profiler: per-phase min/mean/max and histogram of
+ *         the time spent in slot operation.
+ *
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+*/
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+
+#if TSCH_PROFILE_ON
+
+#include <string.h>
+
+static struct tsch_profile_stats profile_stats[TSCH_PROFILE_PHASE_COUNT];
+
+static const char *phase_names[TSCH_PROFILE_PHASE_COUNT] = {
+  "link-selection",
+  "packet-prepare",
+  "security",
+  "radio-tx",
+  "ack-wait",
+  "rx-processing",
+};
+
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_record(enum tsch_profile_phase phase, rtimer_clock_t duration)
+{
+  struct tsch_profile_stats *stats;
+  uint32_t duration_us;
+  uint8_t bin;
+
+  if(phase >= TSCH_PROFILE_PHASE_COUNT) {
+    return;
+  }
+  stats = &profile_stats[phase];
+
+  if(stats->count == TSCH_PROFILE_COUNT_MAX) {
+    /* Saturated: stop here rather than corrupting the mean */
+    return;
+  }
+
+  if(stats->count == 0 || duration < stats->min) {
+    stats->min = duration;
+  }
+  if(duration > stats->max) {
+    stats->max = duration;
+  }
+  stats->sum += duration;
+  stats->count++;
+
+  /* Logarithmic bins, in micro-seconds */
+  duration_us = RTIMERTICKS_TO_US(duration);
+  for(bin = 0; bin < TSCH_PROFILE_HISTOGRAM_BINS - 1; bin++) {
+    if(duration_us < ((uint32_t)TSCH_PROFILE_FIRST_BIN_US << bin)) {
+      break;
+    }
+  }
+  stats->histogram[bin]++;
+}
+/*---------------------------------------------------------------------------*/
+const struct tsch_profile_stats *
+tsch_profile_get(enum tsch_profile_phase phase)
+{
+  if(phase >= TSCH_PROFILE_PHASE_COUNT) {
+    return NULL;
+  }
+  return &profile_stats[phase];
+}
+/*---------------------------------------------------------------------------*/
+const char *
+tsch_profile_phase_name(enum tsch_profile_phase phase)
+{
+  if(phase >= TSCH_PROFILE_PHASE_COUNT) {
+    return NULL;
+  }
+  return phase_names[phase];
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_profile_reset(void)
+{
+  memset(profile_stats, 0, sizeof(profile_stats));
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_PROFILE_ON */
+/** @} */
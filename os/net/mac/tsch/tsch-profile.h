@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Header file for the TSCH slot profiler. Records how long each
+ *         phase of slot operation takes, to check which code eats into
+ *         the timeslot guard times.
+ *
+ */
+
+/**
+ * \addtogroup tsch
+ * @{
+*/
+
+#ifndef __TSCH_PROFILE_H__
+#define __TSCH_PROFILE_H__
+
+/********** Includes **********/
+
+#include "contiki.h"
+
+/************ Constants ***********/
+
+/* Enable the slot profiler? Adds a few RTIMER_NOW() calls to each slot */
+#ifdef TSCH_PROFILE_CONF_ON
+#define TSCH_PROFILE_ON TSCH_PROFILE_CONF_ON
+#else
+#define TSCH_PROFILE_ON 0
+#endif
+
+/* Number of histogram bins per phase. Bin i holds durations below
+ * (TSCH_PROFILE_FIRST_BIN_US << i) micro-seconds; the last bin holds
+ * everything above. */
+#ifdef TSCH_PROFILE_CONF_HISTOGRAM_BINS
+#define TSCH_PROFILE_HISTOGRAM_BINS TSCH_PROFILE_CONF_HISTOGRAM_BINS
+#else
+#define TSCH_PROFILE_HISTOGRAM_BINS 8
+#endif
+
+/* Upper bound of the first histogram bin, in micro-seconds */
+#ifdef TSCH_PROFILE_CONF_FIRST_BIN_US
+#define TSCH_PROFILE_FIRST_BIN_US TSCH_PROFILE_CONF_FIRST_BIN_US
+#else
+#define TSCH_PROFILE_FIRST_BIN_US 32
+#endif
+
+/************ Types ***********/
+
+/** \brief The slot operation phases measured by the profiler */
+enum tsch_profile_phase {
+  /* Selecting the next active link and computing the next wakeup */
+  TSCH_PROFILE_LINK_SELECTION,
+  /* Tx: getting the packet ready (including security) and loading it to the radio */
+  TSCH_PROFILE_PACKET_PREPARE,
+  /* Securing or authenticating a frame or ACK */
+  TSCH_PROFILE_SECURITY,
+  /* Tx: the radio transmit call */
+  TSCH_PROFILE_RADIO_TX,
+  /* Tx: from the end of transmission until the ACK is read */
+  TSCH_PROFILE_ACK_WAIT,
+  /* Rx: from reading the frame until the ACK is ready (or the frame queued) */
+  TSCH_PROFILE_RX_PROCESSING,
+  TSCH_PROFILE_PHASE_COUNT, /* Not a phase */
+};
+
+/* Number of durations after which a phase stops recording */
+#define TSCH_PROFILE_COUNT_MAX 0xffff
+
+/** \brief Aggregated durations of a phase, in rtimer ticks */
+struct tsch_profile_stats {
+  uint32_t sum;
+  /** Stops at TSCH_PROFILE_COUNT_MAX, the profile is then frozen until
+   it is reset */
+  uint16_t count;
+  rtimer_clock_t min;
+  rtimer_clock_t max;
+  uint16_t histogram[TSCH_PROFILE_HISTOGRAM_BINS];
+};
+
+/************ Functions ***********/
+
+#if TSCH_PROFILE_ON
+
+/* Start measuring: store the current time in var (must be static in protothreads) */
+#define TSCH_PROFILE_START(var) ((var) = RTIMER_NOW())
+/* Stop measuring, and record the time elapsed since var for a given phase */
+#define TSCH_PROFILE_END(phase, var) tsch_profile_record((phase), RTIMER_NOW() - (var))
+
+/**
+ * \brief Record one duration for a phase. Called from slot operation.
+ * \param phase The phase
+ * \param duration The duration, in rtimer ticks
+ */
+void tsch_profile_record(enum tsch_profile_phase phase, rtimer_clock_t duration);
+
+/**
+ * \brief Get the aggregated stats of a phase
+ * \param phase The phase
+ * \return A pointer to the stats, updated from interrupt
+ */
+const struct tsch_profile_stats *tsch_profile_get(enum tsch_profile_phase phase);
+
+/**
+ * \brief Get a printable name for a phase
+ * \param phase The phase
+ * \return The name of the phase
+ */
+const char *tsch_profile_phase_name(enum tsch_profile_phase phase);
+
+/**
+ * \brief Clear all recorded stats
+ */
+void tsch_profile_reset(void);
+
+#else /* TSCH_PROFILE_ON */
+
+#define TSCH_PROFILE_START(var)
+#define TSCH_PROFILE_END(phase, var)
+#define tsch_profile_record(phase, duration)
+#define tsch_profile_get(phase) NULL
+#define tsch_profile_phase_name(phase) NULL
+#define tsch_profile_reset()
+
+#endif /* TSCH_PROFILE_ON */
+
+#endif /* __TSCH_PROFILE_H__ */
+/** @} */
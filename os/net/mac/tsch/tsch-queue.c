@@ -55,6 +55,7 @@
 #include "net/queuebuf.h"
 #include "net/mac/tsch/tsch.h"
 #include "net/nbr-table.h"
+#include "net/link-stats.h"
 #include <string.h>
 
 /* Log configuration */
@@ -75,6 +76,11 @@ NBR_TABLE(struct tsch_neighbor, tsch_neighbors);
 struct tsch_neighbor *n_broadcast;
 struct tsch_neighbor *n_eb;
 
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/* Clock offset of a neighbor we never got timing from */
+#define SYNC_OFFSET_UNKNOWN 0xffff
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+
 /*---------------------------------------------------------------------------*/
 /* Add a TSCH neighbor */
 struct tsch_neighbor *
@@ -98,6 +104,11 @@ tsch_queue_add_nbr(const linkaddr_t *addr)
         n->is_broadcast = linkaddr_cmp(addr, &tsch_eb_address)
           || linkaddr_cmp(addr, &tsch_broadcast_address);
         tsch_queue_backoff_reset(n);
+        tsch_stats_init_neighbor(n);
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+        n->sync_offset = SYNC_OFFSET_UNKNOWN;
+        n->join_priority = 0xff;
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
       }
       tsch_release_lock();
     }
@@ -120,17 +131,130 @@ struct tsch_neighbor *
 tsch_queue_get_time_source(void)
 {
   if(!tsch_is_locked()) {
-    struct tsch_neighbor *curr_nbr = (struct tsch_neighbor *)nbr_table_head(tsch_neighbors);
+    nbr_table_iterator_t it;
+    struct tsch_neighbor *curr_nbr = (struct tsch_neighbor *)nbr_table_iterator_first(&it, tsch_neighbors);
     while(curr_nbr != NULL) {
       if(curr_nbr->is_time_source) {
         return curr_nbr;
       }
-      curr_nbr = (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, curr_nbr);
+      curr_nbr = (struct tsch_neighbor *)nbr_table_iterator_next(&it);
     }
   }
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/* Is the neighbor tracked as a candidate backup time source? */
+static int
+is_backup_candidate(const struct tsch_neighbor *n)
+{
+  return !n->is_broadcast && !n->is_time_source
+         && n->join_priority < tsch_join_priority;
+}
+/*---------------------------------------------------------------------------*/
+/* Could the neighbor take over as time source right now? It must be closer
+ * to the root than we are, be in sync with us within a quarter of the
+ * guard time, and have given us timing within the max keep-alive timeout. */
+static int
+is_backup_time_source(const struct tsch_neighbor *n)
+{
+  uint32_t max_age = 100 * TSCH_CLOCK_TO_SLOTS(TSCH_MAX_KEEPALIVE_TIMEOUT / 100,
+                                               tsch_timing[tsch_ts_timeslot_length]);
+  return is_backup_candidate(n)
+         && n->sync_offset <= US_TO_RTIMERTICKS(tsch_timing_us[tsch_ts_rx_wait] / 4)
+         && TSCH_ASN_DIFF(tsch_current_asn, n->last_sync_asn) <= max_age;
+}
+/*---------------------------------------------------------------------------*/
+/* Record a clock offset measured against a neighbor. Interrupt-safe. */
+void
+tsch_queue_update_nbr_sync(struct tsch_neighbor *n, int32_t offset)
+{
+  uint16_t abs_offset;
+  if(n == NULL || n->is_broadcast) {
+    return;
+  }
+  abs_offset = MIN(ABS(offset), SYNC_OFFSET_UNKNOWN - 1);
+  n->last_sync_asn = tsch_current_asn;
+  if(n->sync_offset == SYNC_OFFSET_UNKNOWN) {
+    n->sync_offset = abs_offset;
+  } else {
+    /* EWMA with alpha 1/4 */
+    n->sync_offset = ((uint32_t)n->sync_offset * 3 + abs_offset) / 4;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static int
+count_backup_candidates(void)
+{
+  int count = 0;
+  struct tsch_neighbor *n = (struct tsch_neighbor *)nbr_table_head(tsch_neighbors);
+  while(n != NULL) {
+    if(is_backup_candidate(n)) {
+      count++;
+    }
+    n = (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, n);
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+/* Record the join priority a neighbor advertised in its EB */
+void
+tsch_queue_update_nbr_join_priority(const linkaddr_t *addr, uint8_t join_priority)
+{
+  struct tsch_neighbor *n = tsch_queue_get_nbr(addr);
+  if(n == NULL && join_priority < tsch_join_priority) {
+    /* Make room by dropping the candidates that went stale */
+    if(count_backup_candidates() >= TSCH_MAX_BACKUP_TIME_SOURCES) {
+      tsch_queue_free_unused_neighbors();
+    }
+    if(count_backup_candidates() < TSCH_MAX_BACKUP_TIME_SOURCES) {
+      n = tsch_queue_add_nbr(addr);
+    }
+  }
+  if(n != NULL) {
+    n->join_priority = join_priority;
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Get the best neighbor to fail over to if we lose our time source */
+struct tsch_neighbor *
+tsch_queue_get_backup_time_source(void)
+{
+  struct tsch_neighbor *best = NULL;
+  uint16_t best_etx = 0xffff;
+  if(!tsch_is_locked()) {
+    nbr_table_iterator_t it;
+    struct tsch_neighbor *curr_nbr = (struct tsch_neighbor *)nbr_table_iterator_first(&it, tsch_neighbors);
+    while(curr_nbr != NULL) {
+      if(is_backup_time_source(curr_nbr)) {
+        const struct link_stats *stats = link_stats_from_lladdr(nbr_table_iterator_lladdr(&it));
+        uint16_t etx = stats != NULL ? stats->etx : 0xffff;
+        /* Prefer the best link, then the neighbor closest to the root */
+        if(best == NULL || etx < best_etx
+           || (etx == best_etx && curr_nbr->join_priority < best->join_priority)) {
+          best = curr_nbr;
+          best_etx = etx;
+        }
+      }
+      curr_nbr = (struct tsch_neighbor *)nbr_table_iterator_next(&it);
+    }
+  }
+  return best;
+}
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+/*---------------------------------------------------------------------------*/
+struct tsch_neighbor *
+tsch_queue_first_nbr(void)
+{
+  return (struct tsch_neighbor *)nbr_table_head(tsch_neighbors);
+}
+/*---------------------------------------------------------------------------*/
+struct tsch_neighbor *
+tsch_queue_next_nbr(struct tsch_neighbor *neighbor)
+{
+  return (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, neighbor);
+}
+/*---------------------------------------------------------------------------*/
 linkaddr_t *
 tsch_queue_get_nbr_address(const struct tsch_neighbor *n)
 {
@@ -403,9 +527,14 @@ tsch_queue_free_unused_neighbors(void)
     while(n != NULL) {
       struct tsch_neighbor *next_n = (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, n);
       /* Queue is empty, no tx link to this neighbor: deallocate.
-       * Always keep time source and virtual broadcast neighbors. */
+       * Always keep time source and virtual broadcast neighbors,
+       * and the neighbors we could fail over to. */
       if(!n->is_broadcast && !n->is_time_source && !n->tx_links_count
-         && tsch_queue_is_empty(n)) {
+         && tsch_queue_is_empty(n)
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+         && !is_backup_time_source(n)
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+         ) {
         tsch_queue_remove_nbr(n);
       }
       n = next_n;
@@ -432,13 +561,15 @@ tsch_queue_get_packet_for_nbr(const struct tsch_neighbor *n, struct tsch_link *l
           !(is_shared_link && !tsch_queue_backoff_expired(n))) {    /* If this is a shared link,
                                                                     make sure the backoff has expired */
 #if TSCH_WITH_LINK_SELECTOR
-        int packet_attr_slotframe = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
-        int packet_attr_timeslot = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
-        if(packet_attr_slotframe != 0xffff && packet_attr_slotframe != link->slotframe_handle) {
-          return NULL;
-        }
-        if(packet_attr_timeslot != 0xffff && packet_attr_timeslot != link->timeslot) {
-          return NULL;
+        if(link->slotframe_handle != TSCH_LINK_SELECTOR_OPEN_SLOTFRAME || is_shared_link) {
+          int packet_attr_slotframe = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_SLOTFRAME);
+          int packet_attr_timeslot = queuebuf_attr(n->tx_array[get_index]->qb, PACKETBUF_ATTR_TSCH_TIMESLOT);
+          if(packet_attr_slotframe != 0xffff && packet_attr_slotframe != link->slotframe_handle) {
+            return NULL;
+          }
+          if(packet_attr_timeslot != 0xffff && packet_attr_timeslot != link->timeslot) {
+            return NULL;
+          }
         }
 #endif
         return n->tx_array[get_index];
@@ -464,7 +595,8 @@ struct tsch_packet *
 tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link *link)
 {
   if(!tsch_is_locked()) {
-    struct tsch_neighbor *curr_nbr = (struct tsch_neighbor *)nbr_table_head(tsch_neighbors);
+    nbr_table_iterator_t it;
+    struct tsch_neighbor *curr_nbr = (struct tsch_neighbor *)nbr_table_iterator_first(&it, tsch_neighbors);
     struct tsch_packet *p = NULL;
     while(curr_nbr != NULL) {
       if(!curr_nbr->is_broadcast && curr_nbr->tx_links_count == 0) {
@@ -477,7 +609,7 @@ tsch_queue_get_unicast_packet_for_any(struct tsch_neighbor **n, struct tsch_link
           return p;
         }
       }
-      curr_nbr = (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, curr_nbr);
+      curr_nbr = (struct tsch_neighbor *)nbr_table_iterator_next(&it);
     }
   }
   return NULL;
@@ -519,14 +651,15 @@ tsch_queue_update_all_backoff_windows(const linkaddr_t *dest_addr)
 {
   if(!tsch_is_locked()) {
     int is_broadcast = linkaddr_cmp(dest_addr, &tsch_broadcast_address);
-    struct tsch_neighbor *n = (struct tsch_neighbor *)nbr_table_head(tsch_neighbors);
+    nbr_table_iterator_t it;
+    struct tsch_neighbor *n = (struct tsch_neighbor *)nbr_table_iterator_first(&it, tsch_neighbors);
     while(n != NULL) {
       if(n->backoff_window != 0 /* Is the queue in backoff state? */
          && ((n->tx_links_count == 0 && is_broadcast)
-             || (n->tx_links_count > 0 && linkaddr_cmp(dest_addr, tsch_queue_get_nbr_address(n))))) {
+             || (n->tx_links_count > 0 && linkaddr_cmp(dest_addr, nbr_table_iterator_lladdr(&it))))) {
         n->backoff_window--;
       }
-      n = (struct tsch_neighbor *)nbr_table_next(tsch_neighbors, n);
+      n = (struct tsch_neighbor *)nbr_table_iterator_next(&it);
     }
   }
 }
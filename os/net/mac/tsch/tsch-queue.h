@@ -71,6 +71,41 @@ struct tsch_neighbor *tsch_queue_get_nbr(const linkaddr_t *addr);
  * \return The neighbor queue associated to the time source
  */
 struct tsch_neighbor *tsch_queue_get_time_source(void);
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/**
+ * \brief Record a clock offset measured against a neighbor that is not our
+ * time source. Interrupt-safe.
+ * \param n The neighbor
+ * \param offset The measured offset, in rtimer ticks
+ */
+void tsch_queue_update_nbr_sync(struct tsch_neighbor *n, int32_t offset);
+/**
+ * \brief Record the join priority a neighbor advertised in its EB. A
+ * neighbor closer to the root than us is added, and tracked as a candidate
+ * backup time source, if fewer than TSCH_MAX_BACKUP_TIME_SOURCES are tracked.
+ * \param addr The address of the neighbor
+ * \param join_priority The join priority from its EB
+ */
+void tsch_queue_update_nbr_join_priority(const linkaddr_t *addr, uint8_t join_priority);
+/**
+ * \brief Get the neighbor to fail over to if the time source is lost: the
+ * one with the lowest ETX among the recently synchronized neighbors with a
+ * lower join priority than ours
+ * \return The backup time source, NULL if there is none
+ */
+struct tsch_neighbor *tsch_queue_get_backup_time_source(void);
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+/**
+ * \brief Get the first neighbor in the TSCH neighbor table
+ * \return The first neighbor, NULL if the table is empty
+ */
+struct tsch_neighbor *tsch_queue_first_nbr(void);
+/**
+ * \brief Get the next neighbor in the TSCH neighbor table
+ * \param neighbor The current neighbor
+ * \return The next neighbor, NULL if there are no more
+ */
+struct tsch_neighbor *tsch_queue_next_nbr(struct tsch_neighbor *neighbor);
 /**
  * \brief Get the address of a neighbor.
  * \return The link-layer address of the neighbor.
@@ -37,9 +37,8 @@
  */
 
 #include "contiki.h"
-#include "lib/list.h"
-#include "lib/memb.h"
 #include "net/mac/tsch/tsch.h"
+#include <string.h>
 
 /* Log configuration */
 #include "sys/log.h"
@@ -49,22 +48,80 @@
 /*---------------------------------------------------------------------------*/
 #if BUILD_WITH_ORCHESTRA
 /*---------------------------------------------------------------------------*/
+#ifdef TSCH_CONF_MAX_ROOT_NODES
+#define TSCH_MAX_ROOT_NODES TSCH_CONF_MAX_ROOT_NODES
+#else
 #define TSCH_MAX_ROOT_NODES 5
+#endif
 #define ROOT_ALIVE_TIME_SECONDS     (2 * 60 * 60) /* 2h timeout */
 #define PERIODIC_PROCESSING_TICKS   (60 * CLOCK_SECOND)
 
+/* Roots are kept in an open-addressing hash table with linear probing,
+ * at most half full so that lookups end after a probe or two. The lookup
+ * runs for every outgoing packet, from Orchestra's select_packet. */
+#define ROOTS_TABLE_SIZE            (2 * TSCH_MAX_ROOT_NODES + 1)
+
 /*---------------------------------------------------------------------------*/
 /* TSCH roots data structure */
 struct tsch_root_info {
-  struct tsch_root_info *next;
   linkaddr_t address;
   clock_time_t last_seen_seconds; /* the time when this was last seen */
+  uint8_t in_use;
 };
 /*---------------------------------------------------------------------------*/
-MEMB(tsch_root_memb, struct tsch_root_info, TSCH_MAX_ROOT_NODES);
-LIST(tsch_roots);
+static struct tsch_root_info tsch_roots[ROOTS_TABLE_SIZE];
+static uint8_t tsch_roots_count;
 static struct ctimer periodic_timer;
 /*---------------------------------------------------------------------------*/
+/* The slot where probing for an address starts */
+static uint8_t
+home_slot(const linkaddr_t *address)
+{
+  return (address->u8[LINKADDR_SIZE - 1]
+          + (address->u8[LINKADDR_SIZE - 2] << 8)) % ROOTS_TABLE_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static uint8_t
+next_slot(uint8_t i)
+{
+  return i + 1 == ROOTS_TABLE_SIZE ? 0 : i + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Returns the slot holding the address, or the empty slot where it goes */
+static uint8_t
+lookup(const linkaddr_t *address)
+{
+  uint8_t i = home_slot(address);
+  while(tsch_roots[i].in_use && !linkaddr_cmp(address, &tsch_roots[i].address)) {
+    i = next_slot(i);
+  }
+  return i;
+}
+/*---------------------------------------------------------------------------*/
+/* Removes the entry in slot i, and moves back the entries that were
+ * displaced past it so that they can still be found */
+static void
+remove_slot(uint8_t i)
+{
+  uint8_t j = i;
+  while(1) {
+    uint8_t k;
+    j = next_slot(j);
+    if(!tsch_roots[j].in_use) {
+      break;
+    }
+    k = home_slot(&tsch_roots[j].address);
+    /* Leave the entry if its home slot is cyclically within ]i, j] */
+    if(i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+      continue;
+    }
+    tsch_roots[i] = tsch_roots[j];
+    i = j;
+  }
+  tsch_roots[i].in_use = 0;
+  tsch_roots_count--;
+}
+/*---------------------------------------------------------------------------*/
 void
 tsch_roots_add_address(const linkaddr_t *new_root_address)
 {
@@ -75,24 +132,19 @@ tsch_roots_add_address(const linkaddr_t *new_root_address)
   LOG_INFO_("\n");
 
   /* search for an existing entry */
-  root = list_head(tsch_roots);
-  while(root != NULL) {
-    if(linkaddr_cmp(new_root_address, &root->address)) {
-      break;
-    }
-    root = root->next;
-  }
+  root = &tsch_roots[lookup(new_root_address)];
 
-  if(root == NULL) {
+  if(!root->in_use) {
     /* add a new entry */
-    if((root = memb_alloc(&tsch_root_memb)) == NULL) {
+    if(tsch_roots_count >= TSCH_MAX_ROOT_NODES) {
       LOG_ERR("failed to add root ");
       LOG_ERR_LLADDR(new_root_address);
       LOG_ERR_("\n");
       return;
     }
     linkaddr_copy(&root->address, new_root_address);
-    list_add(tsch_roots, root);
+    root->in_use = 1;
+    tsch_roots_count++;
 
     /* make sure there is a link in the schedule */
     TSCH_CALLBACK_ROOT_NODE_UPDATED(&root->address, 1);
@@ -111,43 +163,40 @@ tsch_roots_set_self_to_root(uint8_t is_root)
 int
 tsch_roots_is_root(const linkaddr_t *address)
 {
-  struct tsch_root_info *root;
-  if(address == NULL) {
+  if(address == NULL || tsch_roots_count == 0) {
     return 0;
   }
-
-  root = list_head(tsch_roots);
-  while(root != NULL) {
-    if(linkaddr_cmp(address, &root->address)) {
-      return 1;
-    }
-    root = root->next;
-  }
-  return 0;
+  return tsch_roots[lookup(address)].in_use;
 }
 /*---------------------------------------------------------------------------*/
 static void
 periodic(void *ptr)
 {
+  linkaddr_t expired[TSCH_MAX_ROOT_NODES];
   struct tsch_root_info *root;
-  struct tsch_root_info *next;
   clock_time_t now;
+  uint8_t count;
+  uint8_t i;
 
+  /* Collect the obsolete roots first: removing an entry may move others
+   * around the table, including into slots the scan has already passed */
   now = clock_seconds();
-  root = list_head(tsch_roots);
-  while(root != NULL) {
-    next = root->next;
-    if((int32_t)(root->last_seen_seconds + ROOT_ALIVE_TIME_SECONDS - now) < 0) {
-      /* the root info has become obsolete; remove its scheduled link */
-      LOG_INFO("remove root address ");
-      LOG_INFO_LLADDR(&root->address);
-      LOG_INFO_("\n");
-      TSCH_CALLBACK_ROOT_NODE_UPDATED(&root->address, 0);
-      /* remove itself from the table */
-      list_remove(tsch_roots, root);
-      memb_free(&tsch_root_memb, root);
+  count = 0;
+  for(i = 0; i < ROOTS_TABLE_SIZE; i++) {
+    root = &tsch_roots[i];
+    if(root->in_use
+       && (int32_t)(root->last_seen_seconds + ROOT_ALIVE_TIME_SECONDS - now) < 0) {
+      linkaddr_copy(&expired[count++], &root->address);
     }
-    root = next;
+  }
+
+  for(i = 0; i < count; i++) {
+    /* the root info has become obsolete; remove its scheduled link */
+    LOG_INFO("remove root address ");
+    LOG_INFO_LLADDR(&expired[i]);
+    LOG_INFO_("\n");
+    TSCH_CALLBACK_ROOT_NODE_UPDATED(&expired[i], 0);
+    remove_slot(lookup(&expired[i]));
   }
 
   /* schedule the next time */
@@ -157,8 +206,8 @@ periodic(void *ptr)
 void
 tsch_roots_init(void)
 {
-  list_init(tsch_roots);
-  memb_init(&tsch_root_memb);
+  memset(tsch_roots, 0, sizeof(tsch_roots));
+  tsch_roots_count = 0;
   ctimer_set(&periodic_timer, PERIODIC_PROCESSING_TICKS, periodic, NULL);
 }
 /*---------------------------------------------------------------------------*/
@@ -136,6 +136,31 @@ tsch_rpl_callback_parent_switch(rpl_parent_t *old, rpl_parent_t *new)
   }
 }
 /*---------------------------------------------------------------------------*/
+/* TSCH lost its time source and switched to a backup time source. Give the
+ * lost neighbor an infinite rank, as when its IPv6 neighbor entry becomes
+ * unreachable, so that RPL stops routing through it and selects a new
+ * preferred parent. The parent switch then maps the TSCH time source on
+ * that parent. The rank is restored by the next DIO from the neighbor.
+ * To use, set #define TSCH_CALLBACK_TIME_SOURCE_FAILOVER tsch_rpl_callback_time_source_failover */
+void
+tsch_rpl_callback_time_source_failover(const linkaddr_t *old_time_source)
+{
+#if ROUTING_CONF_RPL_LITE
+  rpl_nbr_t *nbr = rpl_neighbor_get_from_lladdr((uip_lladdr_t *)old_time_source);
+  if(curr_instance.used && nbr != NULL) {
+    nbr->rank = RPL_INFINITE_RANK;
+    rpl_timers_schedule_state_update();
+  }
+#else
+  rpl_parent_t *p = rpl_get_parent((const uip_lladdr_t *)old_time_source);
+  if(p != NULL) {
+    p->rank = RPL_INFINITE_RANK;
+    /* Trigger DAG rank recalculation */
+    p->flags |= RPL_PARENT_FLAG_UPDATED;
+  }
+#endif
+}
+/*---------------------------------------------------------------------------*/
 /* Check RPL has joined DODAG.
  * To use, set #define TSCH_RPL_CHECK_DODAG_JOINED tsch_rpl_check_dodag_joined */
 int
@@ -79,6 +79,14 @@ void tsch_rpl_callback_new_dio_interval(clock_time_t dio_interval);
  * \param new The new RPL parent
  */
 void tsch_rpl_callback_parent_switch(rpl_parent_t *old, rpl_parent_t *new);
+/**
+ * \brief Let RPL know that TSCH lost its time source and failed over to a
+ * backup one. RPL stops using the lost neighbor as parent; the parent it
+ * selects instead becomes the TSCH time source.
+ * To use, set TSCH_CALLBACK_TIME_SOURCE_FAILOVER to tsch_rpl_callback_time_source_failover
+ * \param old_time_source The link-layer address of the lost time source
+ */
+void tsch_rpl_callback_time_source_failover(const linkaddr_t *old_time_source);
 /**
  * \brief Check RPL has joined DODAG.
  * To use, set TSCH_RPL_CHECK_DODAG_JOINED tsch_rpl_check_dodag_joined
@@ -92,9 +92,14 @@ tsch_schedule_add_slotframe(uint16_t handle, uint16_t size)
       /* Initialize the slotframe */
       sf->handle = handle;
       TSCH_ASN_DIVISOR_INIT(sf->size, size);
+      TSCH_ASN_MOD_CACHE_INIT(sf->timeslot_cache);
       LIST_STRUCT_INIT(sf, links_list);
       /* Add the slotframe to the global list */
       list_add(slotframe_list, sf);
+      if(TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK && handle == 0) {
+        /* Slotframe 0 is advertised in EBs */
+        tsch_packet_invalidate_eb();
+      }
     }
     LOG_INFO("add_slotframe %u %u\n",
            handle, size);
@@ -183,6 +188,8 @@ tsch_schedule_remove_slotframe(struct tsch_slotframe *slotframe)
       memb_free(&slotframe_memb, slotframe);
       list_remove(slotframe_list, slotframe);
       tsch_release_lock();
+      /* The cached EB template may have been built from this slotframe */
+      tsch_packet_invalidate_eb();
       return 1;
     }
   }
@@ -351,6 +358,11 @@ tsch_schedule_add_link(struct tsch_slotframe *slotframe,
                  print_link_type(link_type), timeslot, channel_offset);
         LOG_INFO_LLADDR(address);
         LOG_INFO_("\n");
+        if(TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+           && slotframe->handle == 0 && timeslot == 0) {
+          /* The link at timeslot 0 of slotframe 0 is advertised in EBs */
+          tsch_packet_invalidate_eb();
+        }
         /* Release the lock before we update the neighbor (will take the lock) */
         tsch_release_lock();
 
@@ -395,6 +407,10 @@ tsch_schedule_remove_link(struct tsch_slotframe *slotframe, struct tsch_link *l)
                print_link_type(l->link_type), l->timeslot, l->channel_offset);
       LOG_INFO_LLADDR(&l->addr);
       LOG_INFO_("\n");
+      if(TSCH_PACKET_EB_WITH_SLOTFRAME_AND_LINK
+         && slotframe->handle == 0 && l->timeslot == 0) {
+        tsch_packet_invalidate_eb();
+      }
 
       list_remove(slotframe->links_list, l);
       memb_free(&link_memb, l);
@@ -553,7 +569,7 @@ tsch_schedule_get_next_active_link(struct tsch_asn_t *asn, uint16_t *time_offset
     /* For each slotframe, look for the earliest occurring link */
     while(sf != NULL) {
       /* Get timeslot from ASN, given the slotframe length */
-      uint16_t timeslot = TSCH_ASN_MOD(*asn, sf->size);
+      uint16_t timeslot = tsch_asn_mod_incremental(asn, &sf->size, &sf->timeslot_cache);
       struct tsch_link *l = list_head(sf->links_list);
       while(l != NULL) {
         uint16_t time_to_timeslot =
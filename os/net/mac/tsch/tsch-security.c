@@ -67,6 +67,30 @@ static aes_key keys[] = {
 };
 #define N_KEYS (sizeof(keys) / sizeof(aes_key))
 
+/* Index of the key currently loaded in CCM_STAR (0: none). TSCH is the only
+ * user of CCM_STAR, so we set the key (and have the driver expand it) only
+ * when switching keys, rather than for every frame. This assumes the driver
+ * keeps the key until the next set_key(); platforms whose driver can lose it
+ * (e.g. a hardware key store not retained in low-power modes) must call
+ * tsch_security_invalidate_key() when that happens, as the CC2538 does when
+ * waking up from PM2. */
+static uint8_t loaded_key_index;
+
+/*---------------------------------------------------------------------------*/
+static void
+tsch_security_load_key(uint8_t key_index)
+{
+  if(key_index != loaded_key_index) {
+    CCM_STAR.set_key(keys[key_index - 1]);
+    loaded_key_index = key_index;
+  }
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_security_invalidate_key(void)
+{
+  loaded_key_index = 0;
+}
 /*---------------------------------------------------------------------------*/
 static void
 tsch_security_init_nonce(uint8_t *nonce,
@@ -193,7 +217,7 @@ tsch_security_secure_frame(uint8_t *hdr, uint8_t *outbuf,
     memcpy(outbuf, hdr, a_len + m_len);
   }
 
-  CCM_STAR.set_key(keys[key_index - 1]);
+  tsch_security_load_key(key_index);
 
   CCM_STAR.aead(nonce,
                 outbuf + a_len, m_len,
@@ -258,7 +282,7 @@ tsch_security_parse_frame(const uint8_t *hdr, int hdrlen, int datalen,
     m_len = 0;
   }
 
-  CCM_STAR.set_key(keys[key_index - 1]);
+  tsch_security_load_key(key_index);
 
   CCM_STAR.aead(nonce,
                 (uint8_t *)hdr + a_len, m_len,
@@ -140,6 +140,14 @@ unsigned int tsch_security_parse_frame(const uint8_t *hdr, int hdrlen,
                                        const linkaddr_t *sender,
                                        struct tsch_asn_t *asn);
 
+/**
+ * \brief Forget which key is loaded in CCM_STAR, so that the next secured
+ * frame sets it again. To be called by platforms whose CCM_STAR driver may
+ * lose its key, e.g. when leaving a low-power mode that does not retain the
+ * crypto engine's key store
+ */
+void tsch_security_invalidate_key(void);
+
 /**
  * \brief Set packetbuf (or eackbuf) attributes depending on a given frame type
  * \param frame_type The frame type (FRAME802154_BEACONFRAME etc.)
@@ -126,11 +126,20 @@ struct tsch_packet *dequeued_array[TSCH_DEQUEUED_ARRAY_SIZE];
  * Will be processed layer by tsch_rx_process_pending */
 struct ringbufindex input_ringbuf;
 struct input_packet input_array[TSCH_MAX_INCOMING_PACKETS];
+#if TSCH_INPUT_BACKPRESSURE_THRESHOLD
+/* Scratch buffer for frames received while input_ringbuf is full.
+ * Such frames are NACKed and never passed to upper layers */
+static struct input_packet input_overflow;
+#endif /* TSCH_INPUT_BACKPRESSURE_THRESHOLD */
 
 /* Updates and reads of the next two variables must be atomic (i.e. both together) */
 /* Last time we received Sync-IE (ACK or data packet from a time source) */
 static struct tsch_asn_t last_sync_asn;
 clock_time_t tsch_last_sync_time; /* Same info, in clock_time_t units */
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/* Set when the pending-events process was asked to find a backup time source */
+static volatile uint8_t failover_pending;
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
 
 /* A global lock for manipulating data structures safely from outside of interrupt */
 static volatile int tsch_locked = 0;
@@ -163,6 +172,13 @@ static struct tsch_link *backup_link = NULL;
 static struct tsch_packet *current_packet = NULL;
 static struct tsch_neighbor *current_neighbor = NULL;
 
+#if TSCH_PROFILE_ON
+/* Timestamps used by the slot profiler: t0 for the outer phase,
+ * t1 for phases nested in it */
+static rtimer_clock_t profile_t0;
+static rtimer_clock_t profile_t1;
+#endif /* TSCH_PROFILE_ON */
+
 /* Indicates whether an extra link is needed to handle the current burst */
 static int burst_link_scheduled = 0;
 /* Counts the length of the current burst */
@@ -264,10 +280,14 @@ tsch_get_channel_offset(struct tsch_link *link, struct tsch_packet *p)
 static uint8_t
 tsch_calculate_channel(struct tsch_asn_t *asn, uint16_t channel_offset)
 {
-  uint16_t index_of_0, index_of_offset;
-  index_of_0 = TSCH_ASN_MOD(*asn, tsch_hopping_sequence_length);
-  index_of_offset = (index_of_0 + channel_offset) % tsch_hopping_sequence_length.val;
-  return tsch_hopping_sequence[index_of_offset];
+  static struct tsch_asn_mod_cache_t index_of_0_cache;
+  uint16_t index_of_0;
+  index_of_0 = tsch_asn_mod_incremental(asn, &tsch_hopping_sequence_length, &index_of_0_cache);
+  if(channel_offset >= tsch_hopping_sequence_length.val) {
+    channel_offset %= tsch_hopping_sequence_length.val;
+  }
+  /* The table holds the sequence twice: no wrap-around needed */
+  return tsch_hopping_channel_table[index_of_0 + channel_offset];
 }
 
 /*---------------------------------------------------------------------------*/
@@ -471,6 +491,28 @@ tsch_radio_off(enum tsch_radio_state_off_cmd command)
   }
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/* We are about to lose sync with our time source. Looking for a neighbor
+ * still in sync with us means walking the neighbor table, so leave that
+ * to the pending-events process: it either switches to a backup time source
+ * (see tsch_slot_operation_failover) or leaves the network. Keep the slot
+ * operation running until then. Always returns non-zero. */
+static int
+failover_to_backup_time_source(void)
+{
+  if(!failover_pending) {
+    failover_pending = 1;
+    TSCH_LOG_ADD(tsch_log_message,
+        snprintf(log->message, sizeof(log->message),
+            "!lost TS, sync %u, backup?",
+            (unsigned)TSCH_ASN_DIFF(tsch_current_asn, last_sync_asn));
+    );
+    tsch_request_time_source_failover();
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
 static
 PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 {
@@ -487,6 +529,8 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
   /* tx status */
   static uint8_t mac_tx_status;
+  /* did the receiver signal back-pressure in its ACK? */
+  static uint8_t ack_congested;
   /* is the packet in its neighbor's queue? */
   uint8_t in_queue;
   static int dequeued_index;
@@ -495,6 +539,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
   PT_BEGIN(pt);
 
   TSCH_DEBUG_TX_EVENT();
+  TSCH_PROFILE_START(profile_t0);
+
+  ack_congested = 0;
 
   /* First check if we have space to store a newly dequeued packet (in case of
    * successful Tx or Drop) */
@@ -550,8 +597,10 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
         /* If we are going to encrypt, we need to generate the output in a separate buffer and keep
          * the original untouched. This is to allow for future retransmissions. */
         int with_encryption = queuebuf_attr(current_packet->qb, PACKETBUF_ATTR_SECURITY_LEVEL) & 0x4;
+        TSCH_PROFILE_START(profile_t1);
         packet_len += tsch_security_secure_frame(packet, with_encryption ? encrypted_packet : packet, current_packet->header_len,
             packet_len - current_packet->header_len, &tsch_current_asn);
+        TSCH_PROFILE_END(TSCH_PROFILE_SECURITY, profile_t1);
         if(with_encryption) {
           packet = encrypted_packet;
         }
@@ -562,6 +611,8 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
       if(packet_ready && NETSTACK_RADIO.prepare(packet, packet_len) == 0) { /* 0 means success */
         static rtimer_clock_t tx_duration;
 
+        TSCH_PROFILE_END(TSCH_PROFILE_PACKET_PREPARE, profile_t0);
+
 #if TSCH_CCA_ENABLED
         cca_status = 1;
         /* delay before CCA */
@@ -583,7 +634,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
           TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_tx_offset] - RADIO_DELAY_BEFORE_TX, "TxBeforeTx");
           TSCH_DEBUG_TX_EVENT();
           /* send packet already in radio tx buffer */
+          TSCH_PROFILE_START(profile_t1);
           mac_tx_status = NETSTACK_RADIO.transmit(packet_len);
+          TSCH_PROFILE_END(TSCH_PROFILE_RADIO_TX, profile_t1);
           tx_count++;
           /* Save tx timestamp */
           tx_start_time = current_slot_start + tsch_timing[tsch_ts_tx_offset];
@@ -604,6 +657,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
               uint8_t ack_hdrlen;
               frame802154_t frame;
 
+              TSCH_PROFILE_START(profile_t1);
 #if TSCH_HW_FRAME_FILTERING
               radio_value_t radio_rx_mode;
               /* Entering promiscuous mode so that the radio accepts the enhanced ACK */
@@ -636,6 +690,7 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
               /* Read ack frame */
               ack_len = NETSTACK_RADIO.read((void *)ackbuf, sizeof(ackbuf));
+              TSCH_PROFILE_END(TSCH_PROFILE_ACK_WAIT, profile_t1);
 
               is_time_source = 0;
               /* The radio driver should return 0 if no valid packets are in the rx buffer */
@@ -648,8 +703,12 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
 
 #if LLSEC802154_ENABLED
                 if(ack_len != 0) {
-                  if(!tsch_security_parse_frame(ackbuf, ack_hdrlen, ack_len - ack_hdrlen - tsch_security_mic_len(&frame),
-                      &frame, tsch_queue_get_nbr_address(current_neighbor), &tsch_current_asn)) {
+                  int ack_authenticated;
+                  TSCH_PROFILE_START(profile_t1);
+                  ack_authenticated = tsch_security_parse_frame(ackbuf, ack_hdrlen, ack_len - ack_hdrlen - tsch_security_mic_len(&frame),
+                      &frame, tsch_queue_get_nbr_address(current_neighbor), &tsch_current_asn);
+                  TSCH_PROFILE_END(TSCH_PROFILE_SECURITY, profile_t1);
+                  if(!ack_authenticated) {
                     TSCH_LOG_ADD(tsch_log_message,
                         snprintf(log->message, sizeof(log->message),
                         "!failed to authenticate ACK"));
@@ -664,6 +723,9 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
               }
 
               if(ack_len != 0) {
+                /* The receiver signals a nearly full input queue with the
+                 * frame pending bit of the EACK */
+                ack_congested = tsch_packet_get_frame_pending(ackbuf, ack_len);
                 if(is_time_source) {
                   int32_t eack_time_correction = US_TO_RTIMERTICKS(ack_ies.ie_time_correction);
                   int32_t since_last_timesync = TSCH_ASN_DIFF(tsch_current_asn, last_sync_asn);
@@ -688,12 +750,25 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
                   tsch_last_sync_time = clock_time();
                   tsch_schedule_keepalive(0);
                 }
-                mac_tx_status = MAC_TX_OK;
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+                else {
+                  tsch_queue_update_nbr_sync(current_neighbor, US_TO_RTIMERTICKS(ack_ies.ie_time_correction));
+                }
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+                if(ack_ies.ie_is_nack && ack_congested) {
+                  /* A NACK with the frame pending bit set: the receiver's
+                   * input queue was full and it dropped the frame. Other
+                   * NACKs keep their usual meaning */
+                  mac_tx_status = MAC_TX_NOACK;
+                } else {
+                  mac_tx_status = MAC_TX_OK;
 
-                /* We requested an extra slot and got an ack. This means
-                the extra slot will be scheduled at the received */
-                if(burst_link_requested) {
-                  burst_link_scheduled = 1;
+                  /* We requested an extra slot and got an ack. This means
+                  the extra slot will be scheduled at the received,
+                  unless it is congested */
+                  if(burst_link_requested && !ack_congested) {
+                    burst_link_scheduled = 1;
+                  }
                 }
               } else {
                 mac_tx_status = MAC_TX_NOACK;
@@ -718,14 +793,26 @@ PT_THREAD(tsch_tx_slot(struct pt *pt, struct rtimer *t))
     /* Post TX: Update neighbor queue state */
     in_queue = tsch_queue_packet_sent(current_neighbor, current_packet, current_link, mac_tx_status);
 
+    if(ack_congested
+       && (mac_tx_status == MAC_TX_OK
+           || !(current_link->link_options & LINK_OPTION_SHARED))) {
+      /* Back-pressure from the receiver: skip a few shared slots
+       * to this neighbor, even after a successful transmission.
+       * Failures on shared links already incremented the backoff */
+      tsch_queue_backoff_inc(current_neighbor);
+    }
+
     /* The packet was dequeued, add it to dequeued_ringbuf for later processing */
     if(in_queue == 0) {
       dequeued_array[dequeued_index] = current_packet;
       ringbufindex_put(&dequeued_ringbuf);
     }
 
-    /* If this is an unicast packet to timesource, update stats */
-    if(current_neighbor != NULL && current_neighbor->is_time_source) {
+    /* If this is an unicast packet, update stats. This is done for every
+     * unicast neighbor, to feed the per-channel P(tx) used by channel
+     * selection and the per-neighbor link stats; the neighbor stats
+     * proper are still kept for the time source only */
+    if(current_neighbor != NULL && !current_neighbor->is_broadcast) {
       tsch_stats_tx_packet(current_neighbor, mac_tx_status, tsch_current_channel);
     }
 
@@ -778,9 +865,11 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
   TSCH_DEBUG_RX_EVENT();
 
   input_index = ringbufindex_peek_put(&input_ringbuf);
-  if(input_index == -1) {
-    input_queue_drop++;
-  } else {
+
+  /* With back-pressure enabled, listen even if the input queue is full:
+   * the frame is then received in a scratch buffer and NACKed, so that
+   * the sender learns right away that it has to back off */
+  if(input_index != -1 || TSCH_INPUT_BACKPRESSURE_THRESHOLD != 0) {
     static struct input_packet *current_input;
     /* Estimated drift based on RX time */
     static int32_t estimated_drift;
@@ -794,7 +883,11 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
     /* Default start time: expected Rx time */
     rx_start_time = expected_rx_time;
 
+#if TSCH_INPUT_BACKPRESSURE_THRESHOLD
+    current_input = input_index != -1 ? &input_array[input_index] : &input_overflow;
+#else /* TSCH_INPUT_BACKPRESSURE_THRESHOLD */
     current_input = &input_array[input_index];
+#endif /* TSCH_INPUT_BACKPRESSURE_THRESHOLD */
 
     /* Wait before starting to listen */
     TSCH_SCHEDULE_AND_YIELD(pt, t, current_slot_start, tsch_timing[tsch_ts_rx_offset] - RADIO_DELAY_BEFORE_RX, "RxBeforeListen");
@@ -830,6 +923,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
         radio_value_t radio_last_lqi;
 
         /* Read packet */
+        TSCH_PROFILE_START(profile_t0);
         current_input->len = NETSTACK_RADIO.read((void *)current_input->payload, TSCH_PACKET_MAX_LEN);
         NETSTACK_RADIO.get_value(RADIO_PARAM_LAST_RSSI, &radio_last_rssi);
         current_input->rx_asn = tsch_current_asn;
@@ -868,9 +962,13 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
 #if LLSEC802154_ENABLED
         /* Decrypt and verify incoming frame */
         if(frame_valid) {
-          if(tsch_security_parse_frame(
+          int frame_authenticated;
+          TSCH_PROFILE_START(profile_t1);
+          frame_authenticated = tsch_security_parse_frame(
                current_input->payload, header_len, current_input->len - header_len - tsch_security_mic_len(&frame),
-               &frame, &source_address, &tsch_current_asn)) {
+               &frame, &source_address, &tsch_current_asn);
+          TSCH_PROFILE_END(TSCH_PROFILE_SECURITY, profile_t1);
+          if(frame_authenticated) {
             current_input->len -= tsch_security_mic_len(&frame);
           } else {
             TSCH_LOG_ADD(tsch_log_message,
@@ -889,6 +987,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
                || linkaddr_cmp(&destination_address, &linkaddr_null))
              && !linkaddr_cmp(&source_address, &linkaddr_node_addr)) {
             int do_nack = 0;
+            static int input_congested;
             rx_count++;
             estimated_drift = RTIMER_CLOCK_DIFF(expected_rx_time, rx_start_time);
             tsch_stats_on_time_synchronization(estimated_drift);
@@ -911,6 +1010,17 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
             }
 #endif
 
+            /* No room for this frame: NACK it */
+            if(input_index == -1) {
+              do_nack = 1;
+              input_queue_drop++;
+              tsch_stats_on_input_queue_drop();
+            }
+            /* Is the input queue (nearly) full? */
+            input_congested = TSCH_INPUT_BACKPRESSURE_THRESHOLD != 0
+              && (input_index == -1
+                  || ringbufindex_elements(&input_ringbuf) + 1 >= TSCH_INPUT_BACKPRESSURE_THRESHOLD);
+
             if(frame.fcf.ack_required) {
               static uint8_t ack_buf[TSCH_PACKET_MAX_LEN];
               static int ack_len;
@@ -920,15 +1030,25 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
                   &source_address, frame.seq, (int16_t)RTIMERTICKS_TO_US(estimated_drift), do_nack);
 
               if(ack_len > 0) {
+                if(input_congested && (input_index == -1 || !do_nack)) {
+                  /* Signal back-pressure through the frame pending bit of the ACK.
+                   * On a NACK, the bit means that the frame was dropped for lack
+                   * of room, so leave it clear on NACKs requested by
+                   * TSCH_CALLBACK_DO_NACK */
+                  tsch_packet_set_frame_pending(ack_buf, ack_len);
+                }
 #if LLSEC802154_ENABLED
                 if(tsch_is_pan_secured) {
                   /* Secure ACK frame. There is only header and header IEs, therefore data len == 0. */
+                  TSCH_PROFILE_START(profile_t1);
                   ack_len += tsch_security_secure_frame(ack_buf, ack_buf, ack_len, 0, &tsch_current_asn);
+                  TSCH_PROFILE_END(TSCH_PROFILE_SECURITY, profile_t1);
                 }
 #endif /* LLSEC802154_ENABLED */
 
                 /* Copy to radio buffer */
                 NETSTACK_RADIO.prepare((const void *)ack_buf, ack_len);
+                TSCH_PROFILE_END(TSCH_PROFILE_RX_PROCESSING, profile_t0);
 
                 /* Wait for time to ACK and transmit ACK */
                 TSCH_SCHEDULE_AND_YIELD(pt, t, rx_start_time,
@@ -937,8 +1057,12 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
                 NETSTACK_RADIO.transmit(ack_len);
                 tsch_radio_off(TSCH_RADIO_CMD_OFF_WITHIN_TIMESLOT);
 
-                /* Schedule a burst link iff the frame pending bit was set */
-                burst_link_scheduled = tsch_packet_get_frame_pending(current_input->payload, current_input->len);
+                /* Schedule a burst link iff the frame pending bit was set,
+                 * and we have room for more frames */
+                burst_link_scheduled = !input_congested
+                  && tsch_packet_get_frame_pending(current_input->payload, current_input->len);
+              } else {
+                TSCH_PROFILE_END(TSCH_PROFILE_RX_PROCESSING, profile_t0);
               }
             }
 
@@ -956,9 +1080,21 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
               tsch_timesync_update(n, since_last_timesync, -estimated_drift);
               tsch_schedule_keepalive(0);
             }
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+            else {
+              /* Keep track of how well we are in sync with the other neighbors */
+              tsch_queue_update_nbr_sync(n, estimated_drift);
+            }
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
 
-            /* Add current input to ringbuf */
-            ringbufindex_put(&input_ringbuf);
+            if(input_index != -1) {
+              /* Add current input to ringbuf */
+              ringbufindex_put(&input_ringbuf);
+              tsch_stats_on_input_queue(ringbufindex_elements(&input_ringbuf));
+            }
+            if(!frame.fcf.ack_required) {
+              TSCH_PROFILE_END(TSCH_PROFILE_RX_PROCESSING, profile_t0);
+            }
 
             /* If the neighbor is known, update its stats */
             if(n != NULL) {
@@ -991,7 +1127,7 @@ PT_THREAD(tsch_rx_slot(struct pt *pt, struct rtimer *t))
     if(input_queue_drop != 0) {
       TSCH_LOG_ADD(tsch_log_message,
           snprintf(log->message, sizeof(log->message),
-              "!queue full skipped %u", input_queue_drop);
+              "!queue full dropped %u", input_queue_drop);
       );
       input_queue_drop = 0;
     }
@@ -1035,6 +1171,11 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       is_drift_correction_used = 0;
       /* Get a packet ready to be sent */
       current_packet = get_packet_and_neighbor_for_link(current_link, &current_neighbor);
+#ifdef TSCH_CALLBACK_TX_LINK_ELAPSED
+      if(current_link->link_options & LINK_OPTION_TX) {
+        TSCH_CALLBACK_TX_LINK_ELAPSED(current_link, current_packet != NULL);
+      }
+#endif
       uint8_t do_skip_best_link = 0;
       if(current_packet == NULL && backup_link != NULL) {
         /* There is no packet to send, and this link does not have Rx flag. Instead of doing
@@ -1102,7 +1243,11 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
 
     /* Do we need to resynchronize? i.e., wait for EB again */
     if(!tsch_is_coordinator && (TSCH_ASN_DIFF(tsch_current_asn, last_sync_asn) >
-        (100 * TSCH_CLOCK_TO_SLOTS(TSCH_DESYNC_THRESHOLD / 100, tsch_timing[tsch_ts_timeslot_length])))) {
+        (100 * TSCH_CLOCK_TO_SLOTS(TSCH_DESYNC_THRESHOLD / 100, tsch_timing[tsch_ts_timeslot_length])))
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+       && !failover_to_backup_time_source()
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+       ) {
       TSCH_LOG_ADD(tsch_log_message,
             snprintf(log->message, sizeof(log->message),
                 "! leaving the network, last sync %u",
@@ -1118,6 +1263,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
       rtimer_clock_t time_to_next_active_slot;
       /* Schedule next wakeup skipping slots if missed deadline */
       do {
+        TSCH_PROFILE_START(profile_t0);
         update_link_backoff(current_link);
 
         /* A burst link was scheduled. Replay the current link at the
@@ -1151,6 +1297,7 @@ PT_THREAD(tsch_slot_operation(struct rtimer *t, void *ptr))
         /* Update current slot start */
         prev_slot_start = current_slot_start;
         current_slot_start += time_to_next_active_slot;
+        TSCH_PROFILE_END(TSCH_PROFILE_LINK_SELECTION, profile_t0);
       } while(!tsch_schedule_slot_operation(t, prev_slot_start, time_to_next_active_slot, "main"));
     }
 
@@ -1203,8 +1350,28 @@ tsch_slot_operation_sync(rtimer_clock_t next_slot_start,
   status = critical_enter();
   last_sync_asn = tsch_current_asn;
   tsch_last_sync_time = clock_time();
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+  failover_pending = 0;
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
   critical_exit(status);
   current_link = NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/* Resume synchronized operation with a new time source */
+void
+tsch_slot_operation_failover(const struct tsch_asn_t *sync_asn)
+{
+  int_master_status_t status;
+
+  status = critical_enter();
+  /* Rely on the timing the new time source last gave us, if more recent */
+  if((int32_t)TSCH_ASN_DIFF(*sync_asn, last_sync_asn) > 0) {
+    last_sync_asn = *sync_asn;
+  }
+  failover_pending = 0;
+  critical_exit(status);
+}
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+/*---------------------------------------------------------------------------*/
 /** @} */
@@ -89,6 +89,14 @@ void tsch_release_lock(void);
  */
 void tsch_slot_operation_sync(rtimer_clock_t next_slot_start,
     struct tsch_asn_t *next_slot_asn);
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/**
+ * Resume synchronized operation after switching to a backup time source
+ *
+ * \param sync_asn the ASN of the last frame that gave us timing from the new time source
+ */
+void tsch_slot_operation_failover(const struct tsch_asn_t *sync_asn);
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
 /**
  * Start actual slot operation
  */
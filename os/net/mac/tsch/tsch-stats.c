@@ -38,6 +38,7 @@
 #include "net/mac/tsch/tsch.h"
 #include "net/netstack.h"
 #include "dev/radio.h"
+#include <string.h>
 
 /* Log configuration */
 #include "sys/log.h"
@@ -56,18 +57,30 @@ static struct ctimer periodic_timer;
 
 static void periodic(void *);
 
+#if TSCH_STATS_PER_NEIGHBOR
+/* The per-neighbor stats use alpha = 1/4, rounded towards the new value,
+ * as with 8-bit values a truncating 1/8 EWMA would get stuck far from it */
+static int16_t
+link_ewma_update(int16_t x, int16_t v)
+{
+  int16_t diff = v - x;
+  return x + (diff >= 0 ? (diff + 2) / 4 : (diff - 2) / 4);
+}
+#endif /* TSCH_STATS_PER_NEIGHBOR */
+
 /*---------------------------------------------------------------------------*/
 void
 tsch_stats_init(void)
 {    
-#if TSCH_STATS_SAMPLE_NOISE_RSSI
   int i;
 
   for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
+#if TSCH_STATS_SAMPLE_NOISE_RSSI
     tsch_stats.noise_rssi[i] = TSCH_STATS_DEFAULT_RSSI;
     tsch_stats.channel_free_ewma[i] = TSCH_STATS_DEFAULT_CHANNEL_FREE;
-  }
 #endif
+    tsch_stats.channel_p_tx_success[i] = TSCH_STATS_DEFAULT_CHANNEL_P_TX;
+  }
 
   tsch_stats_reset_neighbor_stats();
 
@@ -99,16 +112,63 @@ tsch_stats_get_from_neighbor(struct tsch_neighbor *n)
   return NULL;
 }
 /*---------------------------------------------------------------------------*/
+#if TSCH_STATS_PER_NEIGHBOR
+void
+tsch_stats_init_neighbor(struct tsch_neighbor *n)
+{
+  memset(n->link_stats.p_tx_success, TSCH_STATS_LINK_DEFAULT_P_TX,
+         sizeof(n->link_stats.p_tx_success));
+  memset(n->link_stats.rssi, (uint8_t)TSCH_STATS_LINK_RSSI_UNKNOWN,
+         sizeof(n->link_stats.rssi));
+}
+/*---------------------------------------------------------------------------*/
+tsch_stat_t
+tsch_stats_get_link_p_tx(const struct tsch_neighbor *n, uint8_t channel)
+{
+  uint8_t index = tsch_stats_channel_to_index(channel);
+  if(n == NULL || index >= TSCH_STATS_NUM_CHANNELS) {
+    return TSCH_STATS_BINARY_SCALING_FACTOR;
+  }
+  return (uint32_t)n->link_stats.p_tx_success[index] * TSCH_STATS_BINARY_SCALING_FACTOR
+    / TSCH_STATS_LINK_P_TX_SCALING_FACTOR;
+}
+/*---------------------------------------------------------------------------*/
+int8_t
+tsch_stats_get_link_rssi(const struct tsch_neighbor *n, uint8_t channel)
+{
+  uint8_t index = tsch_stats_channel_to_index(channel);
+  if(n == NULL || index >= TSCH_STATS_NUM_CHANNELS) {
+    return TSCH_STATS_LINK_RSSI_UNKNOWN;
+  }
+  return n->link_stats.rssi[index];
+}
+/*---------------------------------------------------------------------------*/
+int
+tsch_stats_is_link_channel_bad(const struct tsch_neighbor *n, uint8_t channel)
+{
+  return tsch_stats_get_link_p_tx(n, channel) < TSCH_STATS_LINK_BAD_P_TX;
+}
+#endif /* TSCH_STATS_PER_NEIGHBOR */
+/*---------------------------------------------------------------------------*/
 void
 tsch_stats_tx_packet(struct tsch_neighbor *n, uint8_t mac_status, uint8_t channel)
 {
   struct tsch_neighbor_stats *stats;
+  uint8_t index = tsch_stats_channel_to_index(channel);
+  uint16_t new_tx_value = (mac_status == MAC_TX_OK ? 1 : 0);
+  new_tx_value *= TSCH_STATS_BINARY_SCALING_FACTOR;
+
+  TSCH_STATS_EWMA_UPDATE(tsch_stats.channel_p_tx_success[index], new_tx_value);
+
+#if TSCH_STATS_PER_NEIGHBOR
+  if(n != NULL) {
+    n->link_stats.p_tx_success[index] = link_ewma_update(n->link_stats.p_tx_success[index],
+        mac_status == MAC_TX_OK ? TSCH_STATS_LINK_P_TX_SCALING_FACTOR : 0);
+  }
+#endif /* TSCH_STATS_PER_NEIGHBOR */
 
   stats = tsch_stats_get_from_neighbor(n);
   if(stats != NULL) {
-    uint8_t index = tsch_stats_channel_to_index(channel);
-    uint16_t new_tx_value = (mac_status == MAC_TX_OK ? 1 : 0);
-    new_tx_value *= TSCH_STATS_BINARY_SCALING_FACTOR;
     TSCH_STATS_EWMA_UPDATE(stats->channel_stats[index].p_tx_success, new_tx_value);
   }
 }
@@ -117,11 +177,21 @@ void
 tsch_stats_rx_packet(struct tsch_neighbor *n, int8_t rssi, uint8_t lqi, uint8_t channel)
 {
   struct tsch_neighbor_stats *stats;
+  uint8_t index = tsch_stats_channel_to_index(channel);
+
+#if TSCH_STATS_PER_NEIGHBOR
+  if(n != NULL) {
+    int8_t *link_rssi = &n->link_stats.rssi[index];
+    if(*link_rssi == TSCH_STATS_LINK_RSSI_UNKNOWN) {
+      *link_rssi = rssi;
+    } else {
+      *link_rssi = link_ewma_update(*link_rssi, rssi);
+    }
+  }
+#endif /* TSCH_STATS_PER_NEIGHBOR */
 
   stats = tsch_stats_get_from_neighbor(n);
   if(stats != NULL) {
-    uint8_t index = tsch_stats_channel_to_index(channel);
-
     TSCH_STATS_EWMA_UPDATE(stats->channel_stats[index].rssi,
         TSCH_STATS_TRANSFORM(rssi, TSCH_STATS_RSSI_SCALING_FACTOR));
     TSCH_STATS_EWMA_UPDATE(stats->channel_stats[index].lqi,
@@ -137,6 +207,19 @@ tsch_stats_on_time_synchronization(int32_t sync_error)
 }
 /*---------------------------------------------------------------------------*/
 void
+tsch_stats_on_input_queue(uint8_t queue_len)
+{
+  /* Keep track of the high-water mark of the input queue */
+  tsch_stats.input_queue_max_len = MAX(tsch_stats.input_queue_max_len, queue_len);
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_stats_on_input_queue_drop(void)
+{
+  tsch_stats.input_queue_drops++;
+}
+/*---------------------------------------------------------------------------*/
+void
 tsch_stats_sample_rssi(void)
 {
 #if TSCH_STATS_SAMPLE_NOISE_RSSI
@@ -206,6 +289,18 @@ periodic(void *ptr)
   }
 #endif
 
+  LOG_DBG("P(tx) over all neighbors:\n");
+  for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
+    LOG_DBG("  channel %u: %u/%u\n",
+        TSCH_STATS_FIRST_CHANNEL + i,
+        tsch_stats.channel_p_tx_success[i],
+        TSCH_STATS_BINARY_SCALING_FACTOR);
+  }
+
+  LOG_DBG("Input queue: max %u/%u, %u drops\n",
+      tsch_stats.input_queue_max_len, TSCH_MAX_INCOMING_PACKETS,
+      tsch_stats.input_queue_drops);
+
   timesource = tsch_queue_get_time_source();
   if(timesource != NULL) {
     LOG_DBG("Time source neighbor:\n");
@@ -227,7 +322,32 @@ periodic(void *ptr)
     TSCH_STATS_EWMA_UPDATE(stats[i].lqi, TSCH_STATS_DEFAULT_LQI);
     /* decay Tx stats */
     TSCH_STATS_EWMA_UPDATE(stats[i].p_tx_success, TSCH_STATS_DEFAULT_P_TX);
+    TSCH_STATS_EWMA_UPDATE(tsch_stats.channel_p_tx_success[i], TSCH_STATS_DEFAULT_CHANNEL_P_TX);
+  }
+
+#if TSCH_STATS_PER_NEIGHBOR
+  /* decay per-neighbor Tx stats, so that channels marked as bad get another chance */
+  if(!tsch_is_locked()) {
+    struct tsch_neighbor *n;
+    for(n = tsch_queue_first_nbr(); n != NULL; n = tsch_queue_next_nbr(n)) {
+      uint32_t bad_channels = 0;
+      for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
+        if(tsch_stats_is_link_channel_bad(n, tsch_stats_index_to_channel(i))) {
+          bad_channels |= 1ul << i;
+        }
+      }
+      if(bad_channels != 0) {
+        LOG_DBG("Neighbor ");
+        LOG_DBG_LLADDR(tsch_queue_get_nbr_address(n));
+        LOG_DBG_(": bad channels bitmap 0x%lx\n", (unsigned long)bad_channels);
+      }
+      for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
+        n->link_stats.p_tx_success[i] = link_ewma_update(n->link_stats.p_tx_success[i],
+            TSCH_STATS_LINK_DEFAULT_P_TX);
+      }
+    }
   }
+#endif /* TSCH_STATS_PER_NEIGHBOR */
 
   ctimer_set(&periodic_timer, TSCH_STATS_DECAY_INTERVAL, periodic, NULL);
 }
@@ -47,7 +47,6 @@
 #include "contiki.h"
 #include "net/linkaddr.h"
 #include "net/mac/tsch/tsch-conf.h"
-#include "net/mac/tsch/tsch-queue.h"
 
 /************ Constants ***********/
 
@@ -58,6 +57,16 @@
 #define TSCH_STATS_ON 0
 #endif
 
+/*
+ * Keep a per-channel Tx success and Rx RSSI matrix for every neighbor?
+ * Costs 2 * TSCH_STATS_NUM_CHANNELS bytes of RAM per neighbor.
+ */
+#ifdef TSCH_STATS_CONF_PER_NEIGHBOR
+#define TSCH_STATS_PER_NEIGHBOR (TSCH_STATS_ON && TSCH_STATS_CONF_PER_NEIGHBOR)
+#else
+#define TSCH_STATS_PER_NEIGHBOR 0
+#endif
+
 /* Enable the collection background noise RSSI? */
 #ifdef TSCH_STATS_CONF_SAMPLE_NOISE_RSSI
 #define TSCH_STATS_SAMPLE_NOISE_RSSI TSCH_STATS_CONF_SAMPLE_NOISE_RSSI
@@ -128,6 +137,23 @@
 #define TSCH_STATS_DEFAULT_P_TX (TSCH_STATS_BINARY_SCALING_FACTOR / 2)
 /* The default value for channel free status: 100% */
 #define TSCH_STATS_DEFAULT_CHANNEL_FREE TSCH_STATS_BINARY_SCALING_FACTOR
+/* The default value for per-channel P_tx over all neighbors: 100% */
+#define TSCH_STATS_DEFAULT_CHANNEL_P_TX TSCH_STATS_BINARY_SCALING_FACTOR
+
+/* The scaling of the compact per-neighbor P_tx statistics: 255 is 100% */
+#define TSCH_STATS_LINK_P_TX_SCALING_FACTOR 255
+/* The default value for per-neighbor P_tx: 100%, i.e. no channel is bad before proven */
+#define TSCH_STATS_LINK_DEFAULT_P_TX TSCH_STATS_LINK_P_TX_SCALING_FACTOR
+/* The per-neighbor RSSI of a channel on which nothing has been received yet */
+#define TSCH_STATS_LINK_RSSI_UNKNOWN INT8_MIN
+
+/* A channel is bad for a neighbor if the P_tx to it is below this */
+#ifdef TSCH_STATS_CONF_LINK_BAD_P_TX
+#define TSCH_STATS_LINK_BAD_P_TX TSCH_STATS_CONF_LINK_BAD_P_TX
+#else
+/* < 50% */
+#define TSCH_STATS_LINK_BAD_P_TX (TSCH_STATS_BINARY_SCALING_FACTOR / 2)
+#endif
 
 /* #define these callbacks to do the adaptive channel selection based on RSSI */
 /* TSCH_CALLBACK_CHANNEL_STATS_UPDATED(channel, previous_metric); */
@@ -143,6 +169,14 @@ struct tsch_global_stats {
   uint32_t max_sync_error;
   /* number of disassociations */
   uint16_t num_disassociations;
+  /* number of incoming packets dropped because the input queue was full.
+     Only counted with back-pressure, without it the node does not listen
+     when the queue is full. */
+  uint16_t input_queue_drops;
+  /* the maximum number of packets seen in the input queue */
+  uint8_t input_queue_max_len;
+  /* per-channel EWMA of P_tx, for unicast transmissions to any neighbor */
+  tsch_stat_t channel_p_tx_success[TSCH_STATS_NUM_CHANNELS];
 #if TSCH_STATS_SAMPLE_NOISE_RSSI
   /* per-channel noise estimates */
   tsch_stat_t noise_rssi[TSCH_STATS_NUM_CHANNELS];
@@ -164,6 +198,14 @@ struct tsch_neighbor_stats {
   struct tsch_channel_stats channel_stats[TSCH_STATS_NUM_CHANNELS];
 };
 
+/* Compact per-neighbor statistics, stored in `struct tsch_neighbor` */
+struct tsch_link_stats {
+  /* EWMA of unicast Tx success probability, scaled by TSCH_STATS_LINK_P_TX_SCALING_FACTOR */
+  uint8_t p_tx_success[TSCH_STATS_NUM_CHANNELS];
+  /* EWMA of Rx RSSI, in dBm */
+  int8_t rssi[TSCH_STATS_NUM_CHANNELS];
+};
+
 struct tsch_neighbor; /* Forward declaration */
 
 
@@ -182,30 +224,76 @@ extern struct tsch_neighbor_stats tsch_neighbor_stats;
 
 void tsch_stats_init(void);
 
+/* Called after every unicast transmission, whatever the neighbor. Neighbor
+ * stats (tsch_neighbor_stats) are only updated for the time source */
 void tsch_stats_tx_packet(struct tsch_neighbor *, uint8_t mac_status, uint8_t channel);
 
 void tsch_stats_rx_packet(struct tsch_neighbor *, int8_t rssi, uint8_t lqi, uint8_t channel);
 
 void tsch_stats_on_time_synchronization(int32_t sync_error);
 
+void tsch_stats_on_input_queue(uint8_t queue_len);
+
+void tsch_stats_on_input_queue_drop(void);
+
 void tsch_stats_sample_rssi(void);
 
 struct tsch_neighbor_stats *tsch_stats_get_from_neighbor(struct tsch_neighbor *);
 
 void tsch_stats_reset_neighbor_stats(void);
 
+#if TSCH_STATS_PER_NEIGHBOR
+
+void tsch_stats_init_neighbor(struct tsch_neighbor *);
+
+/**
+ * \brief Get the unicast Tx success probability to a neighbor on a channel
+ * \param n       The neighbor
+ * \param channel The MAC-layer channel
+ * \return The probability, scaled by TSCH_STATS_BINARY_SCALING_FACTOR
+ */
+tsch_stat_t tsch_stats_get_link_p_tx(const struct tsch_neighbor *n, uint8_t channel);
+
+/**
+ * \brief Get the RSSI of packets from a neighbor received on a channel
+ * \param n       The neighbor
+ * \param channel The MAC-layer channel
+ * \return The RSSI in dBm, or TSCH_STATS_LINK_RSSI_UNKNOWN
+ */
+int8_t tsch_stats_get_link_rssi(const struct tsch_neighbor *n, uint8_t channel);
+
+/**
+ * \brief Check whether a channel is known to be bad for a neighbor,
+ * for example to let a scheduler skip or remap cells on it
+ * \param n       The neighbor
+ * \param channel The MAC-layer channel
+ * \return 1 if the P_tx to the neighbor on this channel is below TSCH_STATS_LINK_BAD_P_TX
+ */
+int tsch_stats_is_link_channel_bad(const struct tsch_neighbor *n, uint8_t channel);
+
+#endif /* TSCH_STATS_PER_NEIGHBOR */
+
 #else /* TSCH_STATS_ON */
 
 #define tsch_stats_init()
 #define tsch_stats_tx_packet(n, mac_status, channel)
 #define tsch_stats_rx_packet(n, rssi, lqi, channel)
 #define tsch_stats_on_time_synchronization(sync_error)
+#define tsch_stats_on_input_queue(queue_len)
+#define tsch_stats_on_input_queue_drop()
 #define tsch_stats_sample_rssi()
 #define tsch_stats_get_from_neighbor(neighbor) NULL
 #define tsch_stats_reset_neighbor_stats()
 
 #endif /* TSCH_STATS_ON */
 
+#if !TSCH_STATS_PER_NEIGHBOR
+#define tsch_stats_init_neighbor(n)
+#define tsch_stats_get_link_p_tx(n, channel) TSCH_STATS_BINARY_SCALING_FACTOR
+#define tsch_stats_get_link_rssi(n, channel) TSCH_STATS_LINK_RSSI_UNKNOWN
+#define tsch_stats_is_link_channel_bad(n, channel) 0
+#endif /* !TSCH_STATS_PER_NEIGHBOR */
+
 static inline uint8_t
 tsch_stats_channel_to_index(uint8_t channel)
 {
@@ -45,6 +45,7 @@
 /********** Includes **********/
 
 #include "net/mac/tsch/tsch-asn.h"
+#include "net/mac/tsch/tsch-stats.h"
 #include "lib/list.h"
 #include "lib/ringbufindex.h"
 
@@ -89,6 +90,8 @@ struct tsch_slotframe {
   /* Number of timeslots in the slotframe.
    * Stored as struct asn_divisor_t because we often need ASN%size */
   struct tsch_asn_divisor_t size;
+  /* ASN % size at the last schedule lookup, updated incrementally */
+  struct tsch_asn_mod_cache_t timeslot_cache;
   /* List of links belonging to this slotframe */
   LIST_STRUCT(links_list);
 };
@@ -119,6 +122,15 @@ struct tsch_neighbor {
   struct tsch_packet *tx_array[TSCH_QUEUE_NUM_PER_NEIGHBOR];
   /* Circular buffer of pointers to packet. */
   struct ringbufindex tx_ringbuf;
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+  struct tsch_asn_t last_sync_asn; /* ASN of the last frame that gave us timing from this neighbor */
+  uint16_t sync_offset; /* Moving average of the clock offset to this neighbor, in rtimer ticks */
+  uint8_t join_priority; /* Join priority advertised in the last EB from this neighbor */
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+#if TSCH_STATS_PER_NEIGHBOR
+  /* Per-channel link quality to this neighbor */
+  struct tsch_link_stats link_stats;
+#endif /* TSCH_STATS_PER_NEIGHBOR */
 };
 
 /** \brief TSCH timeslot timing elements. Used to index timeslot timing
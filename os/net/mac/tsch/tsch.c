@@ -93,6 +93,9 @@ NBR_TABLE(struct eb_stat, eb_stats);
 /* TSCH channel hopping sequence */
 uint8_t tsch_hopping_sequence[TSCH_HOPPING_SEQUENCE_MAX_LEN];
 struct tsch_asn_divisor_t tsch_hopping_sequence_length;
+/* The hopping sequence written twice in a row, so that the channel at
+ * (ASN % length) + (offset % length) is found without another modulo */
+uint8_t tsch_hopping_channel_table[2 * TSCH_HOPPING_SEQUENCE_MAX_LEN];
 
 /* Default TSCH timeslot timing (in micro-second) */
 static const uint16_t *tsch_default_timing_us;
@@ -147,9 +150,18 @@ enum tsch_keepalive_status {
 /* Should we send or schedule a keepalive? */
 static volatile enum tsch_keepalive_status keepalive_status;
 
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/* Has the slot operation asked to switch to a backup time source? */
+static volatile uint8_t time_source_failover_requested;
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+
 /* timer for sending keepalive messages */
 static struct ctimer keepalive_timer;
 
+/* The channel on which we received the EB we last associated from.
+ * Scanning starts on this channel when re-joining. */
+static uint8_t last_association_channel;
+
 /* Statistics on the current session */
 unsigned long tx_count;
 unsigned long rx_count;
@@ -192,6 +204,7 @@ void
 tsch_set_pan_secured(int enable)
 {
   tsch_is_pan_secured = LLSEC802154_ENABLED && enable;
+  tsch_packet_invalidate_eb();
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -207,12 +220,44 @@ tsch_set_ka_timeout(uint32_t timeout)
   tsch_schedule_keepalive(0);
 }
 /*---------------------------------------------------------------------------*/
+uint32_t
+tsch_get_ka_timeout(void)
+{
+  return tsch_current_ka_timeout;
+}
+/*---------------------------------------------------------------------------*/
 void
 tsch_set_eb_period(uint32_t period)
 {
   tsch_current_eb_period = MIN(period, TSCH_MAX_EB_PERIOD);
 }
 /*---------------------------------------------------------------------------*/
+void
+tsch_set_hopping_sequence(const uint8_t *sequence, uint8_t len)
+{
+  if(sequence != tsch_hopping_sequence) {
+    memcpy(tsch_hopping_sequence, sequence, len);
+  }
+  TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, len);
+  memcpy(tsch_hopping_channel_table, tsch_hopping_sequence, len);
+  memcpy(tsch_hopping_channel_table + len, tsch_hopping_sequence, len);
+}
+/*---------------------------------------------------------------------------*/
+/* The period EBs are actually sent at. With adaptive keep-alives, a node whose
+ * keep-alive timeout was stretched stretches its EB period as much. */
+static clock_time_t
+get_eb_period(void)
+{
+#if TSCH_ADAPTIVE_KEEPALIVE
+  if(!tsch_is_coordinator && tsch_current_ka_timeout > TSCH_KEEPALIVE_TIMEOUT) {
+    unsigned long period = (unsigned long)tsch_current_eb_period
+      * tsch_current_ka_timeout / TSCH_KEEPALIVE_TIMEOUT;
+    return MAX(tsch_current_eb_period, MIN(period, TSCH_ADAPTIVE_MAX_EB_PERIOD));
+  }
+#endif /* TSCH_ADAPTIVE_KEEPALIVE */
+  return tsch_current_eb_period;
+}
+/*---------------------------------------------------------------------------*/
 static void
 tsch_reset(void)
 {
@@ -251,11 +296,79 @@ tsch_reset(void)
 #endif /* TSCH_AUTOSELECT_TIME_SOURCE */
   tsch_set_eb_period(TSCH_EB_PERIOD);
   keepalive_status = KEEPALIVE_SCHEDULING_UNCHANGED;
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+  time_source_failover_requested = 0;
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+  /* PAN ID, timing and hopping sequence will be set anew */
+  tsch_packet_invalidate_eb();
+#if LLSEC802154_ENABLED
+  /* Load the keys anew once (re)associated */
+  tsch_security_invalidate_key();
+#endif /* LLSEC802154_ENABLED */
 }
 /* TSCH keep-alive functions */
 
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/*---------------------------------------------------------------------------*/
+/* Make the best backup time source our time source.
+ * Return non-zero if the time source was switched. */
+static int
+switch_to_backup_time_source(void)
+{
+  struct tsch_neighbor *old_time_source = tsch_queue_get_time_source();
+  linkaddr_t old_addr;
+  struct tsch_neighbor *backup = tsch_queue_get_backup_time_source();
+  const linkaddr_t *backup_addr = tsch_queue_get_nbr_address(backup);
+  struct tsch_asn_t backup_sync_asn;
+  uint8_t backup_jp;
+  if(backup_addr == NULL) {
+    return 0;
+  }
+  linkaddr_copy(&old_addr, old_time_source != NULL ?
+                tsch_queue_get_nbr_address(old_time_source) : &linkaddr_null);
+  backup_jp = backup->join_priority;
+  backup_sync_asn = backup->last_sync_asn;
+  if(!tsch_queue_update_time_source(backup_addr)) {
+    return 0;
+  }
+  LOG_WARN("failing over to backup time source ");
+  LOG_WARN_LLADDR(backup_addr);
+  LOG_WARN_(", jp %u\n", backup_jp);
+  tsch_join_priority = backup_jp + 1;
+  tsch_slot_operation_failover(&backup_sync_asn);
+#ifdef TSCH_CALLBACK_TIME_SOURCE_FAILOVER
+  /* The routing layer must stop using the lost time source as well */
+  if(!linkaddr_cmp(&old_addr, &linkaddr_null)) {
+    TSCH_CALLBACK_TIME_SOURCE_FAILOVER(&old_addr);
+  }
+#endif /* TSCH_CALLBACK_TIME_SOURCE_FAILOVER */
+  /* Try to get in sync ASAP */
+  tsch_schedule_keepalive(1);
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+void
+tsch_request_time_source_failover(void)
+{
+  time_source_failover_requested = 1;
+  process_poll(&tsch_pending_events_process);
+}
 /*---------------------------------------------------------------------------*/
-/* Resynchronize to last_eb_nbr.
+static void
+tsch_failover_process_pending(void)
+{
+  if(time_source_failover_requested) {
+    time_source_failover_requested = 0;
+    if(!tsch_is_coordinator && tsch_is_associated
+       && !switch_to_backup_time_source()) {
+      LOG_WARN("! no backup time source left, leaving the network\n");
+      tsch_disassociate();
+    }
+  }
+}
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+/*---------------------------------------------------------------------------*/
+/* Resynchronize to a backup time source if any, else to last_eb_nbr.
  * Return non-zero if this function schedules the next keepalive.
  * Return zero otherwise.
  */
@@ -271,6 +384,12 @@ resynchronize(const linkaddr_t *original_time_source_addr)
     LOG_INFO_("\n");
     return 0;
   }
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+  /* Switch to the best neighbor that is still in sync with us */
+  if(switch_to_backup_time_source()) {
+    return 1;
+  }
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
   /* Switch time source to the last neighbor we received an EB from */
   if(linkaddr_cmp(&last_eb_nbr_addr, &linkaddr_null)) {
     LOG_WARN("not able to re-synchronize, received no EB from other neighbors\n");
@@ -311,6 +430,10 @@ keepalive_packet_sent(void *ptr, int status, int transmissions)
 
   /* We got no ack, try to resynchronize */
   if(status == MAC_TX_NOACK) {
+#if TSCH_ADAPTIVE_KEEPALIVE
+    /* The time source may be slipping away: keep in touch more often */
+    tsch_set_ka_timeout(TSCH_KEEPALIVE_TIMEOUT);
+#endif /* TSCH_ADAPTIVE_KEEPALIVE */
     schedule_next_keepalive = !resynchronize(packetbuf_addr(PACKETBUF_ADDR_RECEIVER));
   }
 
@@ -420,6 +543,15 @@ eb_input(struct input_packet *current_input)
       last_eb_nbr_jp = eb_ies.ie_join_priority;
     }
 
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+    if(!tsch_is_coordinator) {
+      /* Neighbors closer to the root than us are candidates for backup
+       * time sources */
+      tsch_queue_update_nbr_join_priority((linkaddr_t *)&frame.src_addr,
+                                          eb_ies.ie_join_priority);
+    }
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+
 #if TSCH_AUTOSELECT_TIME_SOURCE
     if(!tsch_is_coordinator) {
       /* Maintain EB received counter for every neighbor */
@@ -484,14 +616,16 @@ eb_input(struct input_packet *current_input)
 #endif /* TSCH_AUTOSELECT_TIME_SOURCE */
       }
 
-      /* TSCH hopping sequence */
+      /* TSCH hopping sequence. Take any change advertised by our time
+       * source; the ID is not a version number. EBs from other neighbors
+       * are not considered, so a stale sequence cannot come back from them */
       if(eb_ies.ie_channel_hopping_sequence_id != 0) {
         if(eb_ies.ie_hopping_sequence_len != tsch_hopping_sequence_length.val
             || memcmp((uint8_t *)tsch_hopping_sequence, eb_ies.ie_hopping_sequence_list, tsch_hopping_sequence_length.val)) {
           if(eb_ies.ie_hopping_sequence_len <= sizeof(tsch_hopping_sequence)) {
-            memcpy((uint8_t *)tsch_hopping_sequence, eb_ies.ie_hopping_sequence_list,
-                   eb_ies.ie_hopping_sequence_len);
-            TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, eb_ies.ie_hopping_sequence_len);
+            tsch_set_hopping_sequence(eb_ies.ie_hopping_sequence_list,
+                                      eb_ies.ie_hopping_sequence_len);
+            tsch_packet_invalidate_eb();
 
             LOG_WARN("Updating TSCH hopping sequence from EB\n");
           } else {
@@ -520,13 +654,16 @@ tsch_rx_process_pending()
 
     if(is_data) {
       /* Skip EBs and other control messages */
+#if TSCH_WITH_ZERO_COPY_INPUT
+      /* Reference the frame where it is: the input_array entry is not
+       * reused by slot operation before we remove it from the ringbuf */
+      packetbuf_reference(current_input->payload, current_input->len);
+#else /* TSCH_WITH_ZERO_COPY_INPUT */
       /* Copy to packetbuf for processing */
       packetbuf_copyfrom(current_input->payload, current_input->len);
+#endif /* TSCH_WITH_ZERO_COPY_INPUT */
       packetbuf_set_attr(PACKETBUF_ATTR_RSSI, current_input->rssi);
       packetbuf_set_attr(PACKETBUF_ATTR_CHANNEL, current_input->channel);
-    }
-
-    if(is_data) {
       /* Pass to upper layers */
       packet_input();
     } else if(is_eb) {
@@ -539,6 +676,14 @@ tsch_rx_process_pending()
     /* Remove input from ringbuf */
     ringbufindex_get(&input_ringbuf);
   }
+
+#if TSCH_WITH_ZERO_COPY_INPUT
+  /* The batch is done: make sure the packetbuf does not keep referencing
+   * input_array entries that slot operation may now overwrite */
+  if(packetbuf_is_reference()) {
+    packetbuf_clear();
+  }
+#endif /* TSCH_WITH_ZERO_COPY_INPUT */
 }
 /*---------------------------------------------------------------------------*/
 /* Pass sent packets to upper layer */
@@ -572,8 +717,7 @@ tsch_start_coordinator(void)
 {
   frame802154_set_pan_id(IEEE802154_PANID);
   /* Initialize hopping sequence as default */
-  memcpy(tsch_hopping_sequence, TSCH_DEFAULT_HOPPING_SEQUENCE, sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE));
-  TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE));
+  tsch_set_hopping_sequence(TSCH_DEFAULT_HOPPING_SEQUENCE, sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE));
 #if TSCH_SCHEDULE_WITH_6TISCH_MINIMAL
   tsch_schedule_create_minimal();
 #endif
@@ -599,42 +743,39 @@ tsch_disassociate(void)
   }
 }
 /*---------------------------------------------------------------------------*/
-/* Attempt to associate to a network form an incoming EB */
+/* Check that an incoming EB is one we may join: it must parse, pass the
+ * security and PAN ID checks, and carry a join priority, hopping sequence,
+ * schedule and ASN we can use */
 static int
-tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
+tsch_eb_check(const struct input_packet *input_eb, frame802154_t *frame,
+              struct ieee802154_ies *ies)
 {
-  frame802154_t frame;
-  struct ieee802154_ies ies;
   uint8_t hdrlen;
-  int i;
 
   if(input_eb == NULL || tsch_packet_parse_eb(input_eb->payload, input_eb->len,
-                                              &frame, &ies, &hdrlen, 0) == 0) {
+                                              frame, ies, &hdrlen, 0) == 0) {
     LOG_DBG("! failed to parse packet as EB while scanning (len %u)\n",
         input_eb->len);
     return 0;
   }
 
-  tsch_current_asn = ies.ie_asn;
-  tsch_join_priority = ies.ie_join_priority + 1;
-
 #if TSCH_JOIN_SECURED_ONLY
-  if(frame.fcf.security_enabled == 0) {
+  if(frame->fcf.security_enabled == 0) {
     LOG_ERR("! parse_eb: EB is not secured\n");
     return 0;
   }
 #endif /* TSCH_JOIN_SECURED_ONLY */
 #if LLSEC802154_ENABLED
   if(!tsch_security_parse_frame(input_eb->payload, hdrlen,
-      input_eb->len - hdrlen - tsch_security_mic_len(&frame),
-      &frame, (linkaddr_t*)&frame.src_addr, &tsch_current_asn)) {
+      input_eb->len - hdrlen - tsch_security_mic_len(frame),
+      frame, (linkaddr_t*)&frame->src_addr, &ies->ie_asn)) {
     LOG_ERR("! parse_eb: failed to authenticate\n");
     return 0;
   }
 #endif /* LLSEC802154_ENABLED */
 
 #if !LLSEC802154_ENABLED
-  if(frame.fcf.security_enabled == 1) {
+  if(frame->fcf.security_enabled == 1) {
     LOG_ERR("! parse_eb: we do not support security, but EB is secured\n");
     return 0;
   }
@@ -642,17 +783,68 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
 
 #if TSCH_JOIN_MY_PANID_ONLY
   /* Check if the EB comes from the PAN ID we expect */
-  if(frame.src_pid != IEEE802154_PANID) {
-    LOG_ERR("! parse_eb: PAN ID %x != %x\n", frame.src_pid, IEEE802154_PANID);
+  if(frame->src_pid != IEEE802154_PANID) {
+    LOG_ERR("! parse_eb: PAN ID %x != %x\n", frame->src_pid, IEEE802154_PANID);
     return 0;
   }
 #endif /* TSCH_JOIN_MY_PANID_ONLY */
 
   /* There was no join priority (or 0xff) in the EB, do not join */
-  if(ies.ie_join_priority == 0xff) {
+  if(ies->ie_join_priority == 0xff) {
     LOG_ERR("! parse_eb: no join priority\n");
     return 0;
   }
+  if(ies->ie_join_priority + 1 >= TSCH_MAX_JOIN_PRIORITY) {
+    LOG_ERR("! parse_eb: join priority too high (%u)\n", ies->ie_join_priority);
+    return 0;
+  }
+
+  if(ies->ie_channel_hopping_sequence_id != 0
+     && ies->ie_hopping_sequence_len > sizeof(tsch_hopping_sequence)) {
+    LOG_ERR("! parse_eb: hopping sequence too long (%u)\n", ies->ie_hopping_sequence_len);
+    return 0;
+  }
+
+#if TSCH_CHECK_TIME_AT_ASSOCIATION > 0
+  {
+    /* Divide by 4k and multiply again to avoid integer overflow */
+    uint32_t expected_asn = 4096 * TSCH_CLOCK_TO_SLOTS(clock_time() / 4096, tsch_timing_timeslot_length); /* Expected ASN based on our current time*/
+    int32_t asn_threshold = TSCH_CHECK_TIME_AT_ASSOCIATION * 60ul * TSCH_CLOCK_TO_SLOTS(CLOCK_SECOND, tsch_timing_timeslot_length);
+    int32_t asn_diff = (int32_t)ies->ie_asn.ls4b - expected_asn;
+    if(asn_diff > asn_threshold) {
+      LOG_ERR("! EB ASN rejected %lx %lx %ld\n",
+             ies->ie_asn.ls4b, expected_asn, asn_diff);
+      return 0;
+    }
+  }
+#endif
+
+#if TSCH_INIT_SCHEDULE_FROM_EB
+  if(ies->ie_tsch_slotframe_and_link.num_slotframes != 0
+     && ies->ie_tsch_slotframe_and_link.num_links > FRAME802154E_IE_MAX_LINKS) {
+    LOG_ERR("! parse_eb: too many links in schedule (%u)\n",
+            ies->ie_tsch_slotframe_and_link.num_links);
+    return 0;
+  }
+#endif /* TSCH_INIT_SCHEDULE_FROM_EB */
+
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Attempt to associate to a network form an incoming EB */
+static int
+tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
+{
+  frame802154_t frame;
+  struct ieee802154_ies ies;
+  int i;
+
+  if(!tsch_eb_check(input_eb, &frame, &ies)) {
+    return 0;
+  }
+
+  tsch_current_asn = ies.ie_asn;
+  tsch_join_priority = ies.ie_join_priority + 1;
 
   /* TSCH timeslot timing */
   for(i = 0; i < tsch_ts_elements_count; i++) {
@@ -666,30 +858,11 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
 
   /* TSCH hopping sequence */
   if(ies.ie_channel_hopping_sequence_id == 0) {
-    memcpy(tsch_hopping_sequence, TSCH_DEFAULT_HOPPING_SEQUENCE, sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE));
-    TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE));
+    tsch_set_hopping_sequence(TSCH_DEFAULT_HOPPING_SEQUENCE, sizeof(TSCH_DEFAULT_HOPPING_SEQUENCE));
   } else {
-    if(ies.ie_hopping_sequence_len <= sizeof(tsch_hopping_sequence)) {
-      memcpy(tsch_hopping_sequence, ies.ie_hopping_sequence_list, ies.ie_hopping_sequence_len);
-      TSCH_ASN_DIVISOR_INIT(tsch_hopping_sequence_length, ies.ie_hopping_sequence_len);
-    } else {
-      LOG_ERR("! parse_eb: hopping sequence too long (%u)\n", ies.ie_hopping_sequence_len);
-      return 0;
-    }
+    tsch_set_hopping_sequence(ies.ie_hopping_sequence_list, ies.ie_hopping_sequence_len);
   }
 
-#if TSCH_CHECK_TIME_AT_ASSOCIATION > 0
-  /* Divide by 4k and multiply again to avoid integer overflow */
-  uint32_t expected_asn = 4096 * TSCH_CLOCK_TO_SLOTS(clock_time() / 4096, tsch_timing_timeslot_length); /* Expected ASN based on our current time*/
-  int32_t asn_threshold = TSCH_CHECK_TIME_AT_ASSOCIATION * 60ul * TSCH_CLOCK_TO_SLOTS(CLOCK_SECOND, tsch_timing_timeslot_length);
-  int32_t asn_diff = (int32_t)tsch_current_asn.ls4b - expected_asn;
-  if(asn_diff > asn_threshold) {
-    LOG_ERR("! EB ASN rejected %lx %lx %ld\n",
-           tsch_current_asn.ls4b, expected_asn, asn_diff);
-    return 0;
-  }
-#endif
-
 #if TSCH_INIT_SCHEDULE_FROM_EB
   /* Create schedule */
   if(ies.ie_tsch_slotframe_and_link.num_slotframes == 0) {
@@ -702,23 +875,18 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
   } else {
     /* First, empty current schedule */
     tsch_schedule_remove_all_slotframes();
-    /* We support only 0 or 1 slotframe in this IE */
+    /* We support only 0 or 1 slotframe in this IE. tsch_eb_check made
+     * sure the links fit */
     int num_links = ies.ie_tsch_slotframe_and_link.num_links;
-    if(num_links <= FRAME802154E_IE_MAX_LINKS) {
-      int i;
-      struct tsch_slotframe *sf = tsch_schedule_add_slotframe(
-          ies.ie_tsch_slotframe_and_link.slotframe_handle,
-          ies.ie_tsch_slotframe_and_link.slotframe_size);
-      for(i = 0; i < num_links; i++) {
-        tsch_schedule_add_link(sf,
-            ies.ie_tsch_slotframe_and_link.links[i].link_options,
-            LINK_TYPE_ADVERTISING, &tsch_broadcast_address,
-            ies.ie_tsch_slotframe_and_link.links[i].timeslot,
-            ies.ie_tsch_slotframe_and_link.links[i].channel_offset, 1);
-      }
-    } else {
-      LOG_ERR("! parse_eb: too many links in schedule (%u)\n", num_links);
-      return 0;
+    struct tsch_slotframe *sf = tsch_schedule_add_slotframe(
+        ies.ie_tsch_slotframe_and_link.slotframe_handle,
+        ies.ie_tsch_slotframe_and_link.slotframe_size);
+    for(i = 0; i < num_links; i++) {
+      tsch_schedule_add_link(sf,
+          ies.ie_tsch_slotframe_and_link.links[i].link_options,
+          LINK_TYPE_ADVERTISING, &tsch_broadcast_address,
+          ies.ie_tsch_slotframe_and_link.links[i].timeslot,
+          ies.ie_tsch_slotframe_and_link.links[i].channel_offset, 1);
     }
   }
 #endif /* TSCH_INIT_SCHEDULE_FROM_EB */
@@ -759,6 +927,8 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
       TSCH_CALLBACK_JOINING_NETWORK();
 #endif
 
+      last_association_channel = input_eb->channel;
+
       tsch_association_count++;
       LOG_INFO("association done (%u), sec %u, PAN ID %x, asn-%x.%lx, jp %u, timeslot id %u, hopping id %u, slotframe len %u with %u links, from ",
              tsch_association_count,
@@ -778,6 +948,50 @@ tsch_associate(const struct input_packet *input_eb, rtimer_clock_t timestamp)
   LOG_ERR("! did not associate.\n");
   return 0;
 }
+#if TSCH_SCAN_COLLECT_DURATION > 0
+/* The best EB received so far in the current collection window */
+static struct input_packet best_eb;
+static rtimer_clock_t best_eb_timestamp;
+static uint8_t best_eb_jp = 0xff; /* 0xff: no EB collected */
+/* Time when we received the first EB of the collection window */
+static clock_time_t best_eb_since;
+/* How old the best EB can be when the window ends: the window itself, plus
+ * a margin for the scan loop period. Older timestamps are deemed bogus */
+#define TSCH_SCAN_COLLECT_MAX_AGE \
+  ((uint64_t)RTIMER_SECOND * ((TSCH_SCAN_COLLECT_DURATION + CLOCK_SECOND - 1) / CLOCK_SECOND + 2))
+/* The window is too long for the rtimer: timestamps would wrap around.
+ * This always fails with a 16-bit rtimer */
+typedef char tsch_scan_collect_duration_check[
+  TSCH_SCAN_COLLECT_MAX_AGE < (RTIMER_CLOCK_MAX >> 1) ? 1 : -1];
+/*---------------------------------------------------------------------------*/
+/* Keep an incoming EB if we may join it and it is a better time source than
+ * the best one so far. Only EBs that pass all association checks compete, so
+ * that a foreign or unauthenticated EB cannot take the place of valid ones */
+static void
+tsch_scan_collect_eb(const struct input_packet *input_eb, rtimer_clock_t timestamp)
+{
+  frame802154_t frame;
+  struct ieee802154_ies ies;
+
+  if(!tsch_eb_check(input_eb, &frame, &ies)) {
+    return;
+  }
+
+  if(best_eb_jp == 0xff) {
+    /* First EB of the window */
+    best_eb_since = clock_time();
+  } else if(ies.ie_join_priority > best_eb_jp
+            || (ies.ie_join_priority == best_eb_jp && input_eb->rssi <= best_eb.rssi)) {
+    return;
+  }
+
+  memcpy(&best_eb, input_eb, sizeof(struct input_packet));
+  best_eb_timestamp = timestamp;
+  best_eb_jp = ies.ie_join_priority;
+  LOG_INFO("scan: best EB so far, jp %u, rssi %d, channel %u\n",
+           best_eb_jp, best_eb.rssi, best_eb.channel);
+}
+#endif /* TSCH_SCAN_COLLECT_DURATION > 0 */
 /* Processes and protothreads used by TSCH */
 
 /*---------------------------------------------------------------------------*/
@@ -791,34 +1005,46 @@ PT_THREAD(tsch_scan(struct pt *pt))
 
   static struct input_packet input_eb;
   static struct etimer scan_timer;
+  /* The channel we are currently scanning (0 before the first pick) */
+  static uint8_t current_channel;
   /* Time when we started scanning on current_channel */
   static clock_time_t current_channel_since;
+  /* How long to stay on current_channel, extended by incoming frames */
+  static clock_time_t current_channel_dwell;
 
   TSCH_ASN_INIT(tsch_current_asn, 0, 0);
 
   etimer_set(&scan_timer, CLOCK_SECOND / TSCH_ASSOCIATION_POLL_FREQUENCY);
+  current_channel = 0;
   current_channel_since = clock_time();
+#if TSCH_SCAN_COLLECT_DURATION > 0
+  best_eb_jp = 0xff;
+#endif /* TSCH_SCAN_COLLECT_DURATION > 0 */
 
   while(!tsch_is_associated && !tsch_is_coordinator) {
-    /* Hop to any channel offset */
-    static uint8_t current_channel = 0;
-
     /* We are not coordinator, try to associate */
     rtimer_clock_t t0;
     int is_packet_pending = 0;
     clock_time_t now_time = clock_time();
 
     /* Switch to a (new) channel for scanning */
-    if(current_channel == 0 || now_time - current_channel_since > TSCH_CHANNEL_SCAN_DURATION) {
-      /* Pick a channel at random in TSCH_JOIN_HOPPING_SEQUENCE */
-      uint8_t scan_channel = TSCH_JOIN_HOPPING_SEQUENCE[
-          random_rand() % sizeof(TSCH_JOIN_HOPPING_SEQUENCE)];
+    if(current_channel == 0 || now_time - current_channel_since > current_channel_dwell) {
+      uint8_t scan_channel;
+      if(current_channel == 0 && last_association_channel != 0) {
+        /* Re-joining: start where we last heard our network */
+        scan_channel = last_association_channel;
+      } else {
+        /* Pick a channel at random in TSCH_JOIN_HOPPING_SEQUENCE */
+        scan_channel = TSCH_JOIN_HOPPING_SEQUENCE[
+            random_rand() % sizeof(TSCH_JOIN_HOPPING_SEQUENCE)];
+      }
 
       NETSTACK_RADIO.set_value(RADIO_PARAM_CHANNEL, scan_channel);
       current_channel = scan_channel;
       LOG_INFO("scanning on channel %u\n", scan_channel);
 
       current_channel_since = now_time;
+      current_channel_dwell = TSCH_CHANNEL_SCAN_MIN_DURATION;
     }
 
     /* Turn radio on and wait for EB */
@@ -837,16 +1063,29 @@ PT_THREAD(tsch_scan(struct pt *pt))
       input_eb.len = NETSTACK_RADIO.read(input_eb.payload, TSCH_PACKET_MAX_LEN);
 
       if(input_eb.len > 0) {
+        radio_value_t radio_last_rssi;
+
         /* Save packet timestamp */
         NETSTACK_RADIO.get_object(RADIO_PARAM_LAST_PACKET_TIMESTAMP, &t0, sizeof(rtimer_clock_t));
         t1 = RTIMER_NOW();
+        NETSTACK_RADIO.get_value(RADIO_PARAM_LAST_RSSI, &radio_last_rssi);
+        input_eb.rssi = (signed)radio_last_rssi;
+        input_eb.channel = current_channel;
+
+        /* The channel is in use, keep listening to it a bit longer */
+        current_channel_dwell = MIN(now_time - current_channel_since + TSCH_CHANNEL_SCAN_MIN_DURATION,
+                                    TSCH_CHANNEL_SCAN_DURATION);
 
         /* Parse EB and attempt to associate */
         LOG_INFO("scan: received packet (%u bytes) on channel %u\n", input_eb.len, current_channel);
 
         /* Sanity-check the timestamp */
         if(ABS(RTIMER_CLOCK_DIFF(t0, t1)) < 2ul * RTIMER_SECOND) {
+#if TSCH_SCAN_COLLECT_DURATION > 0
+          tsch_scan_collect_eb(&input_eb, t0);
+#else /* TSCH_SCAN_COLLECT_DURATION > 0 */
           tsch_associate(&input_eb, t0);
+#endif /* TSCH_SCAN_COLLECT_DURATION > 0 */
         } else {
           LOG_WARN("scan: dropping packet, timestamp too far from current time %u %u\n",
             (unsigned)t0,
@@ -856,6 +1095,20 @@ PT_THREAD(tsch_scan(struct pt *pt))
       }
     }
 
+#if TSCH_SCAN_COLLECT_DURATION > 0
+    /* End of the collection window, or EB from the coordinator:
+     * associate with the best EB */
+    if(best_eb_jp != 0xff
+       && (best_eb_jp == 0 || clock_time() - best_eb_since >= TSCH_SCAN_COLLECT_DURATION)) {
+      if(ABS(RTIMER_CLOCK_DIFF(best_eb_timestamp, RTIMER_NOW())) < TSCH_SCAN_COLLECT_MAX_AGE) {
+        tsch_associate(&best_eb, best_eb_timestamp);
+      } else {
+        LOG_WARN("scan: dropping best EB, timestamp too old\n");
+      }
+      best_eb_jp = 0xff;
+    }
+#endif /* TSCH_SCAN_COLLECT_DURATION > 0 */
+
     if(tsch_is_associated) {
       /* End of association, turn the radio off */
       NETSTACK_RADIO.off();
@@ -964,9 +1217,10 @@ PROCESS_THREAD(tsch_send_eb_process, ev, data)
     }
     if(tsch_current_eb_period > 0) {
       /* Next EB transmission with a random delay
-       * within [tsch_current_eb_period*0.75, tsch_current_eb_period[ */
-      delay = (tsch_current_eb_period - tsch_current_eb_period / 4)
-        + random_rand() % (tsch_current_eb_period / 4);
+       * within [eb_period*0.75, eb_period[ */
+      clock_time_t eb_period = get_eb_period();
+      delay = (eb_period - eb_period / 4)
+        + random_rand() % (eb_period / 4);
     } else {
       delay = TSCH_EB_PERIOD;
     }
@@ -988,6 +1242,9 @@ PROCESS_THREAD(tsch_pending_events_process, ev, data)
     tsch_tx_process_pending();
     tsch_log_process_pending();
     tsch_keepalive_process_pending();
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+    tsch_failover_process_pending();
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
 #ifdef TSCH_CALLBACK_SELECT_CHANNELS
     TSCH_CALLBACK_SELECT_CHANNELS();
 #endif
@@ -61,6 +61,7 @@ frequency hopping for enhanced reliability.
 #include "net/mac/tsch/tsch-security.h"
 #include "net/mac/tsch/tsch-schedule.h"
 #include "net/mac/tsch/tsch-stats.h"
+#include "net/mac/tsch/tsch-profile.h"
 #include "net/mac/tsch/tsch-roots.h"
 #if UIP_CONF_IPV6_RPL
 #include "net/mac/tsch/tsch-rpl.h"
@@ -93,6 +94,12 @@ frequency hopping for enhanced reliability.
 #define TSCH_RPL_CHECK_DODAG_JOINED tsch_rpl_check_dodag_joined
 #endif /* TSCH_RPL_CHECK_DODAG_JOINED */
 
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+#ifndef TSCH_CALLBACK_TIME_SOURCE_FAILOVER
+#define TSCH_CALLBACK_TIME_SOURCE_FAILOVER tsch_rpl_callback_time_source_failover
+#endif /* TSCH_CALLBACK_TIME_SOURCE_FAILOVER */
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
+
 #endif /* UIP_CONF_IPV6_RPL */
 
 #if BUILD_WITH_ORCHESTRA
@@ -111,6 +118,14 @@ frequency hopping for enhanced reliability.
 
 #endif /* BUILD_WITH_ORCHESTRA */
 
+#if BUILD_WITH_MSF
+
+#ifndef TSCH_CALLBACK_TX_LINK_ELAPSED
+#define TSCH_CALLBACK_TX_LINK_ELAPSED msf_callback_tx_link_elapsed
+#endif /* TSCH_CALLBACK_TX_LINK_ELAPSED */
+
+#endif /* BUILD_WITH_MSF */
+
 /* Called by TSCH when joining a network */
 #ifdef TSCH_CALLBACK_JOINING_NETWORK
 void TSCH_CALLBACK_JOINING_NETWORK();
@@ -126,6 +141,11 @@ void TSCH_CALLBACK_LEAVING_NETWORK();
 void TSCH_CALLBACK_KA_SENT();
 #endif
 
+/* Called by TSCH after failing over from a lost time source to a backup one */
+#ifdef TSCH_CALLBACK_TIME_SOURCE_FAILOVER
+void TSCH_CALLBACK_TIME_SOURCE_FAILOVER(const linkaddr_t *old_time_source);
+#endif
+
 /* Called by TSCH before sending a EB */
 #ifdef TSCH_RPL_CHECK_DODAG_JOINED
 int TSCH_RPL_CHECK_DODAG_JOINED();
@@ -148,6 +168,13 @@ void TSCH_CALLBACK_NEW_TIME_SOURCE(const struct tsch_neighbor *old, const struct
 int TSCH_CALLBACK_PACKET_READY(void);
 #endif
 
+/* Called by TSCH from interrupt at every Tx link reached, with is_used
+ * nonzero if there is a packet to send in it */
+#ifdef TSCH_CALLBACK_TX_LINK_ELAPSED
+struct tsch_link;
+void TSCH_CALLBACK_TX_LINK_ELAPSED(const struct tsch_link *link, int is_used);
+#endif
+
 /* Called when a new root node, including the local node, is detected to be added or removed */ 
 #ifdef TSCH_CALLBACK_ROOT_NODE_UPDATED
 void TSCH_CALLBACK_ROOT_NODE_UPDATED(const linkaddr_t *, uint8_t is_added);
@@ -180,6 +207,8 @@ extern uint8_t tsch_current_channel_offset;
 /* TSCH channel hopping sequence */
 extern uint8_t tsch_hopping_sequence[TSCH_HOPPING_SEQUENCE_MAX_LEN];
 extern struct tsch_asn_divisor_t tsch_hopping_sequence_length;
+/* The hopping sequence twice in a row, for lookups without modulo */
+extern uint8_t tsch_hopping_channel_table[2 * TSCH_HOPPING_SEQUENCE_MAX_LEN];
 /* TSCH timeslot timing (in micro-second) */
 extern tsch_timeslot_timing_usec tsch_timing_us;
 /* TSCH timeslot timing (in rtimer ticks) */
@@ -229,6 +258,15 @@ void tsch_set_join_priority(uint8_t jp);
  * \param period The period in Clock ticks.
  */
 void tsch_set_eb_period(uint32_t period);
+/**
+ * Set the channel hopping sequence. Must be called whenever the content of
+ * tsch_hopping_sequence changes, as the channel lookup table is derived
+ * from it.
+ *
+ * \param sequence The new sequence, can be tsch_hopping_sequence itself
+ * \param len The sequence length, at most TSCH_HOPPING_SEQUENCE_MAX_LEN
+ */
+void tsch_set_hopping_sequence(const uint8_t *sequence, uint8_t len);
 /**
  * Set the desynchronization timeout after which a node sends a unicasst
  * keep-alive (KA) to its time source. Set to 0 to stop sending KAs. The
@@ -238,6 +276,12 @@ void tsch_set_eb_period(uint32_t period);
  * \param timeout The timeout in Clock ticks.
  */
 void tsch_set_ka_timeout(uint32_t timeout);
+/**
+ * Get the current keep-alive timeout
+ *
+ * \return The timeout in Clock ticks, 0 if no keep-alive is sent
+ */
+uint32_t tsch_get_ka_timeout(void);
 /**
  * Set the node as PAN coordinator
  *
@@ -271,6 +315,13 @@ uint64_t tsch_get_network_uptime_ticks(void);
   * Leave the TSCH network we are currently in
   */
 void tsch_disassociate(void);
+#if TSCH_WITH_BACKUP_TIME_SOURCES
+/**
+  * Switch to a backup time source as soon as possible, leave the network
+  * if there is none. Interrupt-safe.
+  */
+void tsch_request_time_source_failover(void);
+#endif /* TSCH_WITH_BACKUP_TIME_SOURCES */
 
 #endif /* __TSCH_H__ */
 /** @} */
@@ -65,11 +65,27 @@ static uint8_t locked_map[NBR_TABLE_MAX_NEIGHBORS];
 static struct nbr_table *all_tables[MAX_NUM_TABLES];
 /* The current number of tables */
 static unsigned num_tables;
+/* For each table, a bitmap of the neighbors it uses. Same information as
+ * used_map, laid out so that iterating over a table skips unused neighbors
+ * 32 at a time */
+#define USED_BITMAP_WORDS ((NBR_TABLE_MAX_NEIGHBORS + 31) / 32)
+static uint32_t used_bitmap[MAX_NUM_TABLES][USED_BITMAP_WORDS];
 
 /* The neighbor address table */
 MEMB(neighbor_addr_mem, nbr_table_key_t, NBR_TABLE_MAX_NEIGHBORS);
 LIST(nbr_table_keys);
 
+/* Hash index from link-layer address to neighbor index: open addressing
+ * with linear probing, at most half full. Each slot holds a neighbor index
+ * plus one, or zero when empty. */
+#define LLADDR_INDEX_SIZE (2 * NBR_TABLE_MAX_NEIGHBORS + 1)
+#if NBR_TABLE_MAX_NEIGHBORS < 0xff
+typedef uint8_t lladdr_index_slot_t;
+#else
+typedef uint16_t lladdr_index_slot_t;
+#endif
+static lladdr_index_slot_t lladdr_index[LLADDR_INDEX_SIZE];
+
 /*---------------------------------------------------------------------------*/
 static void remove_key(nbr_table_key_t *key, bool do_free);
 /*---------------------------------------------------------------------------*/
@@ -115,24 +131,83 @@ key_from_item(nbr_table_t *table, const nbr_table_item_t *item)
   return key_from_index(index_from_item(table, item));
 }
 /*---------------------------------------------------------------------------*/
+/* The slot of the hash index where probing for a link-layer address starts */
+static unsigned
+lladdr_index_home(const linkaddr_t *lladdr)
+{
+  unsigned hash = 0;
+  int i;
+  for(i = 0; i < LINKADDR_SIZE; i++) {
+    hash = hash * 33 + lladdr->u8[i];
+  }
+  return hash % LLADDR_INDEX_SIZE;
+}
+/*---------------------------------------------------------------------------*/
+static unsigned
+lladdr_index_next(unsigned slot)
+{
+  return slot + 1 == LLADDR_INDEX_SIZE ? 0 : slot + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Get the slot of the hash index holding a link-layer address,
+ * or the empty slot where it would go */
+static unsigned
+lladdr_index_lookup(const linkaddr_t *lladdr)
+{
+  unsigned slot = lladdr_index_home(lladdr);
+  while(lladdr_index[slot] != 0
+        && !linkaddr_cmp(lladdr, &key_from_index(lladdr_index[slot] - 1)->lladdr)) {
+    slot = lladdr_index_next(slot);
+  }
+  return slot;
+}
+/*---------------------------------------------------------------------------*/
+/* Add a key to the hash index */
+static void
+lladdr_index_add(nbr_table_key_t *key)
+{
+  lladdr_index[lladdr_index_lookup(&key->lladdr)] = index_from_key(key) + 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Remove a key from the hash index. The entries that follow it in the same
+ * probe sequence are moved back, so that they can still be found. */
+static void
+lladdr_index_remove(nbr_table_key_t *key)
+{
+  unsigned hole = lladdr_index_lookup(&key->lladdr);
+  unsigned slot = hole;
+  if(lladdr_index[hole] == 0) {
+    return;
+  }
+  while(1) {
+    unsigned home;
+    slot = lladdr_index_next(slot);
+    if(lladdr_index[slot] == 0) {
+      break;
+    }
+    home = lladdr_index_home(&key_from_index(lladdr_index[slot] - 1)->lladdr);
+    /* The entry stays if its home slot is cyclically within ]hole, slot] */
+    if(hole <= slot ? (hole < home && home <= slot) : (hole < home || home <= slot)) {
+      continue;
+    }
+    lladdr_index[hole] = lladdr_index[slot];
+    hole = slot;
+  }
+  lladdr_index[hole] = 0;
+}
+/*---------------------------------------------------------------------------*/
 /* Get the index of a neighbor from its link-layer address */
 static int
 index_from_lladdr(const linkaddr_t *lladdr)
 {
-  nbr_table_key_t *key;
+  lladdr_index_slot_t slot;
   /* Allow lladdr-free insertion, useful e.g. for IPv6 ND.
    * Only one such entry is possible at a time, indexed by linkaddr_null. */
   if(lladdr == NULL) {
     lladdr = &linkaddr_null;
   }
-  key = list_head(nbr_table_keys);
-  while(key != NULL) {
-    if(lladdr && linkaddr_cmp(lladdr, &key->lladdr)) {
-      return index_from_key(key);
-    }
-    key = list_item_next(key);
-  }
-  return -1;
+  slot = lladdr_index[lladdr_index_lookup(lladdr)];
+  return slot != 0 ? slot - 1 : -1;
 }
 /*---------------------------------------------------------------------------*/
 /* Get bit from "used" or "locked" bitmap */
@@ -160,6 +235,14 @@ nbr_set_bit(uint8_t *bitmap, nbr_table_t *table, nbr_table_item_t *item, int val
     } else {
       bitmap[item_index] &= ~(1 << table->index);
     }
+    if(bitmap == used_map) {
+      uint32_t bit = (uint32_t)1 << (item_index & 31);
+      if(value) {
+        used_bitmap[table->index][item_index >> 5] |= bit;
+      } else {
+        used_bitmap[table->index][item_index >> 5] &= ~bit;
+      }
+    }
     return 1;
   } else {
     return 0;
@@ -171,6 +254,7 @@ static void
 remove_key(nbr_table_key_t *key, bool do_free)
 {
   int i;
+  int index;
   for(i = 0; i < MAX_NUM_TABLES; i++) {
     if(all_tables[i] != NULL && all_tables[i]->callback != NULL) {
       /* Call table callback for each table that uses this item */
@@ -181,9 +265,14 @@ remove_key(nbr_table_key_t *key, bool do_free)
     }
   }
   /* Empty used and locked map */
-  used_map[index_from_key(key)] = 0;
-  locked_map[index_from_key(key)] = 0;
-  /* Remove neighbor from list */
+  index = index_from_key(key);
+  for(i = 0; i < MAX_NUM_TABLES; i++) {
+    used_bitmap[i][index >> 5] &= ~((uint32_t)1 << (index & 31));
+  }
+  used_map[index] = 0;
+  locked_map[index] = 0;
+  /* Remove neighbor from list and index */
+  lladdr_index_remove(key);
   list_remove(nbr_table_keys, key);
   if(do_free) {
     /* Release the memory */
@@ -385,6 +474,65 @@ nbr_table_next(nbr_table_t *table, nbr_table_item_t *item)
   return item;
 }
 /*---------------------------------------------------------------------------*/
+/* Index of the lowest bit set in a non-zero word */
+static int
+lowest_bit(uint32_t bits)
+{
+#ifdef __GNUC__
+  return __builtin_ctzl(bits);
+#else
+  int i = 0;
+  while((bits & 1) == 0) {
+    bits >>= 1;
+    i++;
+  }
+  return i;
+#endif
+}
+/*---------------------------------------------------------------------------*/
+/* Get the first neighbor index from start on that is used by a table */
+static int
+next_used_index(const nbr_table_t *table, int start)
+{
+  int word = start >> 5;
+  uint32_t bits;
+  if(start >= NBR_TABLE_MAX_NEIGHBORS) {
+    return -1;
+  }
+  bits = used_bitmap[table->index][word] & (0xffffffffUL << (start & 31));
+  while(bits == 0) {
+    if(++word == USED_BITMAP_WORDS) {
+      return -1;
+    }
+    bits = used_bitmap[table->index][word];
+  }
+  return (word << 5) + lowest_bit(bits);
+}
+/*---------------------------------------------------------------------------*/
+nbr_table_item_t *
+nbr_table_iterator_first(nbr_table_iterator_t *iterator, nbr_table_t *table)
+{
+  iterator->table = table;
+  iterator->index = table != NULL ? next_used_index(table, 0) : -1;
+  return item_from_index(table, iterator->index);
+}
+/*---------------------------------------------------------------------------*/
+nbr_table_item_t *
+nbr_table_iterator_next(nbr_table_iterator_t *iterator)
+{
+  if(iterator->index != -1) {
+    iterator->index = next_used_index(iterator->table, iterator->index + 1);
+  }
+  return item_from_index(iterator->table, iterator->index);
+}
+/*---------------------------------------------------------------------------*/
+linkaddr_t *
+nbr_table_iterator_lladdr(const nbr_table_iterator_t *iterator)
+{
+  nbr_table_key_t *key = key_from_index(iterator->index);
+  return key != NULL ? &key->lladdr : NULL;
+}
+/*---------------------------------------------------------------------------*/
 /* Add a neighbor indexed with its link-layer address */
 nbr_table_item_t *
 nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_reason_t reason, void *data)
@@ -426,6 +574,7 @@ nbr_table_add_lladdr(nbr_table_t *table, const linkaddr_t *lladdr, nbr_table_rea
 
     /* Set link-layer address */
     linkaddr_copy(&key->lladdr, lladdr);
+    lladdr_index_add(key);
   }
 
   /* Get item in the current table */
@@ -96,6 +96,12 @@ typedef struct nbr_table_key {
   linkaddr_t lladdr;
 } nbr_table_key_t;
 
+/* State of a loop through the elements of a table, see nbr_table_iterator_first */
+typedef struct nbr_table_iterator {
+  nbr_table_t *table;
+  int index;
+} nbr_table_iterator_t;
+
 /** \brief A static neighbor table. To be initialized through nbr_table_register(name) */
 #define NBR_TABLE(type, name) \
   static type _##name##_mem[NBR_TABLE_MAX_NEIGHBORS]; \
@@ -117,6 +123,11 @@ int nbr_table_register(nbr_table_t *table, nbr_table_callback *callback);
 int nbr_table_is_registered(nbr_table_t *table);
 nbr_table_item_t *nbr_table_head(nbr_table_t *table);
 nbr_table_item_t *nbr_table_next(nbr_table_t *table, nbr_table_item_t *item);
+/* Same as nbr_table_head/next, but faster and in neighbor index order rather
+ * than in insertion order. Removing the current element is allowed. */
+nbr_table_item_t *nbr_table_iterator_first(nbr_table_iterator_t *iterator, nbr_table_t *table);
+nbr_table_item_t *nbr_table_iterator_next(nbr_table_iterator_t *iterator);
+linkaddr_t *nbr_table_iterator_lladdr(const nbr_table_iterator_t *iterator);
 /** @} */
 
 /** \name Neighbor tables: add and get data */
@@ -61,6 +61,9 @@ static uint8_t hdrlen;
    problems when accessing words. */
 static uint32_t packetbuf_aligned[(PACKETBUF_SIZE + 3) / 4];
 static uint8_t *packetbuf = (uint8_t *)packetbuf_aligned;
+/* Points to the current packet data: either packetbuf itself or an
+   external buffer set with packetbuf_reference() */
+static uint8_t *packetbufptr = (uint8_t *)packetbuf_aligned;
 
 #define DEBUG 0
 #if DEBUG
@@ -76,6 +79,7 @@ packetbuf_clear(void)
 {
   buflen = bufptr = 0;
   hdrlen = 0;
+  packetbufptr = packetbuf;
 
   packetbuf_attr_clear();
 }
@@ -92,6 +96,20 @@ packetbuf_copyfrom(const void *from, uint16_t len)
   return l;
 }
 /*---------------------------------------------------------------------------*/
+void
+packetbuf_reference(void *ptr, uint16_t len)
+{
+  packetbuf_clear();
+  packetbufptr = ptr;
+  buflen = len;
+}
+/*---------------------------------------------------------------------------*/
+int
+packetbuf_is_reference(void)
+{
+  return packetbufptr != packetbuf;
+}
+/*---------------------------------------------------------------------------*/
 int
 packetbuf_copyto(void *to)
 {
@@ -112,6 +130,12 @@ packetbuf_hdralloc(int size)
     return 0;
   }
 
+  if(packetbuf_is_reference()) {
+    /* Bring referenced data into the packetbuf before prepending a header */
+    memcpy(packetbuf, packetbufptr, packetbuf_totlen());
+    packetbufptr = packetbuf;
+  }
+
   /* shift data to the right */
   for(i = packetbuf_totlen() - 1; i >= 0; i--) {
     packetbuf[i + size] = packetbuf[i];
@@ -142,13 +166,13 @@ packetbuf_set_datalen(uint16_t len)
 void *
 packetbuf_dataptr(void)
 {
-  return packetbuf + packetbuf_hdrlen();
+  return packetbufptr + packetbuf_hdrlen();
 }
 /*---------------------------------------------------------------------------*/
 void *
 packetbuf_hdrptr(void)
 {
-  return packetbuf;
+  return packetbufptr;
 }
 /*---------------------------------------------------------------------------*/
 uint16_t
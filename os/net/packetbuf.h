@@ -146,6 +146,29 @@ void packetbuf_set_datalen(uint16_t len);
  */
 int packetbuf_copyfrom(const void *from, uint16_t len);
 
+/**
+ * \brief      Reference external data from the packetbuf, without copying
+ * \param ptr  A pointer to the external data
+ * \param len  The size of the external data
+ *
+ *             This function clears the packetbuf and makes its data
+ *             portion point to an external buffer, for incoming
+ *             packets. The external buffer must remain valid and
+ *             unmodified until the packetbuf is cleared or overwritten.
+ *             If a header is later allocated with packetbuf_hdralloc(),
+ *             the referenced data is first copied into the packetbuf.
+ *
+ */
+void packetbuf_reference(void *ptr, uint16_t len);
+
+/**
+ * \brief      Check if the packetbuf references external data
+ * \retval     Non-zero if the data is referenced (see packetbuf_reference()),
+ *             zero if it is stored in the packetbuf
+ *
+ */
+int packetbuf_is_reference(void);
+
 /**
  * \brief      Copy the entire packetbuf to an external buffer
  * \param to   A pointer to the buffer to which the data is to be copied
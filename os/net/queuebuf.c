@@ -51,6 +51,11 @@
 
 #include <string.h> /* for memcpy() */
 
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "Queuebuf"
+#define LOG_LEVEL LOG_LEVEL_MAC
+
 /* Structure pointing to a buffer either stored
    in RAM or swapped in CFS */
 struct queuebuf {
@@ -71,14 +76,21 @@ struct queuebuf {
 #endif
 };
 
-/* The actual queuebuf data */
+/* The actual queuebuf data. Attributes are stored sparsely: attr_bitmap
+   has bit n set if attribute type n is non-zero, and attrs holds the
+   values of the set attributes in increasing type order. The bitmap is
+   made of bytes so that it takes no padding: two bytes for up to 16
+   attribute types. */
 struct queuebuf_data {
   uint8_t data[PACKETBUF_SIZE];
   uint16_t len;
-  struct packetbuf_attr attrs[PACKETBUF_NUM_ATTRS];
+  uint8_t attr_bitmap[(PACKETBUF_NUM_ATTRS + 7) / 8];
+  packetbuf_attr_t attrs[QUEUEBUF_ATTRS];
   struct packetbuf_addr addrs[PACKETBUF_NUM_ADDRS];
 };
 
+#define ATTR_BIT_IS_SET(b, type) ((b)->attr_bitmap[(type) >> 3] & (1 << ((type) & 7)))
+
 MEMB(bufmem, struct queuebuf, QUEUEBUF_NUM);
 MEMB(buframmem, struct queuebuf_data, QUEUEBUFRAM_NUM);
 
@@ -133,6 +145,9 @@ LIST(queuebuf_list);
 
 #if QUEUEBUF_STATS
 uint8_t queuebuf_len, queuebuf_max_len;
+/* The largest number of attributes queued with a packet, to help
+   tune QUEUEBUF_CONF_ATTRS */
+uint8_t queuebuf_max_attrs;
 #endif /* QUEUEBUF_STATS */
 
 #if WITH_SWAP
@@ -277,6 +292,67 @@ queuebuf_load_to_ram(struct queuebuf *b)
 }
 #endif /* WITH_SWAP */
 /*---------------------------------------------------------------------------*/
+/* Copy the packetbuf attributes and addresses to b. Returns 0, leaving
+   b unchanged, if more than QUEUEBUF_ATTRS attributes are set. */
+static int
+attrs_from_packetbuf(struct queuebuf_data *b)
+{
+  uint8_t type;
+  uint8_t count;
+  packetbuf_attr_t val;
+
+  count = 0;
+  for(type = PACKETBUF_ATTR_NONE + 1; type < PACKETBUF_NUM_ATTRS; type++) {
+    if(packetbuf_attr(type) != 0) {
+      count++;
+    }
+  }
+  if(count > QUEUEBUF_ATTRS) {
+    LOG_WARN("%u packet attributes set, room for %u, increase QUEUEBUF_CONF_ATTRS\n",
+             count, QUEUEBUF_ATTRS);
+    return 0;
+  }
+#if QUEUEBUF_STATS
+  if(count > queuebuf_max_attrs) {
+    queuebuf_max_attrs = count;
+  }
+#endif /* QUEUEBUF_STATS */
+
+  memset(b->attr_bitmap, 0, sizeof(b->attr_bitmap));
+  count = 0;
+  for(type = PACKETBUF_ATTR_NONE + 1; type < PACKETBUF_NUM_ATTRS; type++) {
+    val = packetbuf_attr(type);
+    if(val != 0) {
+      b->attr_bitmap[type >> 3] |= 1 << (type & 7);
+      b->attrs[count++] = val;
+    }
+  }
+  for(type = 0; type < PACKETBUF_NUM_ADDRS; type++) {
+    linkaddr_copy(&b->addrs[type].addr,
+                  packetbuf_addr(PACKETBUF_ADDR_FIRST + type));
+  }
+  return 1;
+}
+/*---------------------------------------------------------------------------*/
+/* Set the attributes and addresses stored in b in packetbuf, which is
+   expected to have been cleared */
+static void
+attrs_to_packetbuf(const struct queuebuf_data *b)
+{
+  uint8_t type;
+  uint8_t i;
+
+  i = 0;
+  for(type = PACKETBUF_ATTR_NONE + 1; type < PACKETBUF_NUM_ATTRS; type++) {
+    if(ATTR_BIT_IS_SET(b, type)) {
+      packetbuf_set_attr(type, b->attrs[i++]);
+    }
+  }
+  for(type = 0; type < PACKETBUF_NUM_ADDRS; type++) {
+    packetbuf_set_addr(PACKETBUF_ADDR_FIRST + type, &b->addrs[type].addr);
+  }
+}
+/*---------------------------------------------------------------------------*/
 void
 queuebuf_init(void)
 {
@@ -291,6 +367,7 @@ queuebuf_init(void)
   memb_init(&bufmem);
 #if QUEUEBUF_STATS
   queuebuf_max_len = 0;
+  queuebuf_max_attrs = 0;
 #endif /* QUEUEBUF_STATS */
 }
 /*---------------------------------------------------------------------------*/
@@ -340,8 +417,21 @@ queuebuf_new_from_packetbuf(void)
     buframptr = buf->ram_ptr;
 #endif
 
+    if(!attrs_from_packetbuf(buframptr)) {
+#if WITH_SWAP
+      if(buf->location == IN_RAM) {
+        memb_free(&buframmem, buf->ram_ptr);
+      }
+#else
+      memb_free(&buframmem, buf->ram_ptr);
+#endif
+#if QUEUEBUF_DEBUG
+      list_remove(queuebuf_list, buf);
+#endif /* QUEUEBUF_DEBUG */
+      memb_free(&bufmem, buf);
+      return NULL;
+    }
     buframptr->len = packetbuf_copyto(buframptr->data);
-    packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
 
 #if WITH_SWAP
     if(buf->location == IN_CFS) {
@@ -367,29 +457,35 @@ queuebuf_new_from_packetbuf(void)
   return buf;
 }
 /*---------------------------------------------------------------------------*/
-void
+int
 queuebuf_update_attr_from_packetbuf(struct queuebuf *buf)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
-  packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+  if(!attrs_from_packetbuf(buframptr)) {
+    return 0;
+  }
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
   }
 #endif
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
-void
+int
 queuebuf_update_from_packetbuf(struct queuebuf *buf)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(buf);
-  packetbuf_attr_copyto(buframptr->attrs, buframptr->addrs);
+  if(!attrs_from_packetbuf(buframptr)) {
+    return 0;
+  }
   buframptr->len = packetbuf_copyto(buframptr->data);
 #if WITH_SWAP
   if(buf->location == IN_CFS) {
     queuebuf_flush_tmpdata();
   }
 #endif
+  return 1;
 }
 /*---------------------------------------------------------------------------*/
 void
@@ -422,7 +518,7 @@ queuebuf_to_packetbuf(struct queuebuf *b)
   if(memb_inmemb(&bufmem, b)) {
     struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
     packetbuf_copyfrom(buframptr->data, buframptr->len);
-    packetbuf_attr_copyfrom(buframptr->attrs, buframptr->addrs);
+    attrs_to_packetbuf(buframptr);
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -454,7 +550,25 @@ packetbuf_attr_t
 queuebuf_attr(struct queuebuf *b, uint8_t type)
 {
   struct queuebuf_data *buframptr = queuebuf_load_to_ram(b);
-  return buframptr->attrs[type].val;
+  uint8_t lower;
+  uint8_t i;
+  uint8_t n;
+
+  if(type >= PACKETBUF_NUM_ATTRS || !ATTR_BIT_IS_SET(buframptr, type)) {
+    return 0;
+  }
+  /* The value's index is the number of set attributes below it */
+  i = 0;
+  for(n = 0; n <= type >> 3; n++) {
+    lower = buframptr->attr_bitmap[n];
+    if(n == type >> 3) {
+      lower &= (1 << (type & 7)) - 1;
+    }
+    for(; lower != 0; i++) {
+      lower &= lower - 1;
+    }
+  }
+  return buframptr->attrs[i];
 }
 /*---------------------------------------------------------------------------*/
 void
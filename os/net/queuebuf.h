@@ -68,6 +68,20 @@
 #define QUEUEBUF_NUM 8
 #endif
 
+/* QUEUEBUF_ATTRS is the number of packetbuf attributes a queuebuf can
+   store. Only attributes with a non-zero value take a slot. queuebufs
+   only hold outgoing frames, so the default leaves out
+   PACKETBUF_ATTR_NONE, the three attributes that describe a received
+   frame (link quality, RSSI and timestamp) and the two that only TSCH
+   enhanced ACKs use (no source and no destination address). A packet
+   with more attributes set than this cannot be queued, and a warning is
+   logged. */
+#ifdef QUEUEBUF_CONF_ATTRS
+#define QUEUEBUF_ATTRS QUEUEBUF_CONF_ATTRS
+#else
+#define QUEUEBUF_ATTRS (PACKETBUF_NUM_ATTRS - 6)
+#endif
+
 /* QUEUEBUFRAM_NUM is the number of queuebufs stored in RAM.
    If QUEUEBUFRAM_CONF_NUM is set lower than QUEUEBUF_NUM,
    swapping is enabled and queuebufs are stored either in RAM of CFS.
@@ -101,8 +115,10 @@ struct queuebuf *queuebuf_new_from_packetbuf_debug(const char *file, int line);
 #else /* QUEUEBUF_DEBUG */
 struct queuebuf *queuebuf_new_from_packetbuf(void);
 #endif /* QUEUEBUF_DEBUG */
-void queuebuf_update_attr_from_packetbuf(struct queuebuf *b);
-void queuebuf_update_from_packetbuf(struct queuebuf *b);
+/* Both return 0, leaving the queuebuf unchanged, if packetbuf has more
+   attributes set than a queuebuf can store */
+int queuebuf_update_attr_from_packetbuf(struct queuebuf *b);
+int queuebuf_update_from_packetbuf(struct queuebuf *b);
 
 void queuebuf_to_packetbuf(struct queuebuf *b);
 void queuebuf_free(struct queuebuf *b);
@@ -325,6 +325,20 @@
 #define RPL_WITH_PROBING 1
 #endif
 
+/*
+ * Install the DODAG prefix as 6LoWPAN address context 0, and restore the
+ * static context 0 when the prefix is removed. As the prefix is carried
+ * by DIOs, all nodes of the DODAG compress global addresses with the same
+ * context. Disabled by default: a node that has not joined yet, or that
+ * is not built with this option, still uses the static context and
+ * cannot decompress addresses of a DODAG with another prefix.
+ */
+#ifdef RPL_CONF_WITH_IPHC_CONTEXT
+#define RPL_WITH_IPHC_CONTEXT RPL_CONF_WITH_IPHC_CONTEXT
+#else
+#define RPL_WITH_IPHC_CONTEXT 0
+#endif
+
 /*
  * RPL probing interval.
  */
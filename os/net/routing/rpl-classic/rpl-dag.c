@@ -51,6 +51,7 @@
 #include "net/ipv6/uip.h"
 #include "net/ipv6/uip-nd6.h"
 #include "net/ipv6/uip-ds6-nbr.h"
+#include "net/ipv6/sicslowpan.h"
 #include "net/nbr-table.h"
 #include "net/ipv6/multicast/uip-mcast6.h"
 #include "lib/list.h"
@@ -508,6 +509,11 @@ check_prefix(rpl_prefix_t *last_prefix, rpl_prefix_t *new_prefix)
       LOG_DBG_("\n");
       uip_ds6_addr_add(&ipaddr, 0, ADDR_AUTOCONF);
     }
+#if RPL_WITH_IPHC_CONTEXT
+    sicslowpan_addr_context_set(0, &new_prefix->prefix);
+  } else {
+    sicslowpan_addr_context_reset(0);
+#endif /* RPL_WITH_IPHC_CONTEXT */
   }
 }
 /*---------------------------------------------------------------------------*/
@@ -528,6 +534,9 @@ rpl_set_prefix(rpl_dag_t *dag, uip_ipaddr_t *prefix, unsigned len)
   dag->prefix_info.length = len;
   dag->prefix_info.flags = UIP_ND6_RA_FLAG_AUTONOMOUS;
   LOG_INFO("Prefix set - will announce this in DIOs\n");
+#if RPL_WITH_IPHC_CONTEXT
+  sicslowpan_addr_context_set(0, &dag->prefix_info.prefix);
+#endif /* RPL_WITH_IPHC_CONTEXT */
   if(dag->rank != ROOT_RANK(dag->instance)) {
     /* Autoconfigure an address if this node does not already have an address
        with this prefix. Otherwise, update the prefix */
@@ -862,6 +871,7 @@ best_parent(rpl_dag_t *dag, int fresh_only)
   rpl_parent_t *p;
   rpl_of_t *of;
   rpl_parent_t *best = NULL;
+  nbr_table_iterator_t it;
 
   if(dag == NULL || dag->instance == NULL || dag->instance->of == NULL) {
     return NULL;
@@ -869,7 +879,7 @@ best_parent(rpl_dag_t *dag, int fresh_only)
 
   of = dag->instance->of;
   /* Search for the best parent according to the OF */
-  for(p = nbr_table_head(rpl_parents); p != NULL; p = nbr_table_next(rpl_parents, p)) {
+  for(p = nbr_table_iterator_first(&it, rpl_parents); p != NULL; p = nbr_table_iterator_next(&it)) {
 
     /* Exclude parents from other DAGs or announcing an infinite rank */
     if(p->dag != dag || p->rank == RPL_INFINITE_RANK || p->rank < ROOT_RANK(dag->instance)) {
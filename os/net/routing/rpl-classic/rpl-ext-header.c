@@ -302,6 +302,8 @@ insert_srh_header(void)
   uip_sr_node_t *node;
   rpl_dag_t *dag;
   uip_ipaddr_t node_addr;
+  const uip_sr_srh_cache_t *cached;
+  uip_sr_srh_cache_t *entry;
 
   /* Always insest SRH as first extension header */
   struct uip_routing_hdr *rh_hdr = (struct uip_routing_hdr *)UIP_IP_PAYLOAD(0);
@@ -321,48 +323,60 @@ insert_srh_header(void)
     return 0;
   }
 
-  dest_node = uip_sr_get_node(dag, &UIP_IP_BUF->destipaddr);
-  if(dest_node == NULL) {
-    /* The destination is not found, skip SRH insertion */
-    return 1;
-  }
+  /* Reuse the header computed for an earlier packet if the graph has not
+     changed since */
+  cached = uip_sr_srh_cache_lookup(dag, &UIP_IP_BUF->destipaddr);
+  dest_node = NULL;
+  root_node = NULL;
 
-  root_node = uip_sr_get_node(dag, &dag->dag_id);
-  if(root_node == NULL) {
-    LOG_ERR("SRH root node not found\n");
-    return 0;
-  }
+  if(cached != NULL) {
+    path_len = cached->path_len;
+    cmpri = cached->cmpr;
+    cmpre = cached->cmpr;
+  } else {
+    dest_node = uip_sr_get_node(dag, &UIP_IP_BUF->destipaddr);
+    if(dest_node == NULL) {
+      /* The destination is not found, skip SRH insertion */
+      return 1;
+    }
 
-  if(!uip_sr_is_addr_reachable(dag, &UIP_IP_BUF->destipaddr)) {
-    LOG_ERR("SRH no path found to destination\n");
-    return 0;
-  }
+    root_node = uip_sr_get_node(dag, &dag->dag_id);
+    if(root_node == NULL) {
+      LOG_ERR("SRH root node not found\n");
+      return 0;
+    }
+
+    if(!uip_sr_is_addr_reachable(dag, &UIP_IP_BUF->destipaddr)) {
+      LOG_ERR("SRH no path found to destination\n");
+      return 0;
+    }
 
-  /* Compute path length and compression factors (we use cmpri == cmpre) */
-  path_len = 0;
-  node = dest_node->parent;
-  /* For simplicity, we use cmpri = cmpre */
-  cmpri = 15;
-  cmpre = 15;
+    /* Compute path length and compression factors (we use cmpri == cmpre) */
+    path_len = 0;
+    node = dest_node->parent;
+    /* For simplicity, we use cmpri = cmpre */
+    cmpri = 15;
+    cmpre = 15;
 
-  if(node == root_node) {
-    LOG_DBG("SRH no need to insert SRH\n");
-    return 1;
-  }
+    if(node == root_node) {
+      LOG_DBG("SRH no need to insert SRH\n");
+      return 1;
+    }
 
-  while(node != NULL && node != root_node) {
+    while(node != NULL && node != root_node) {
 
-    NETSTACK_ROUTING.get_sr_node_ipaddr(&node_addr, node);
+      NETSTACK_ROUTING.get_sr_node_ipaddr(&node_addr, node);
 
-    /* How many bytes in common between all nodes in the path? */
-    cmpri = MIN(cmpri, count_matching_bytes(&node_addr, &UIP_IP_BUF->destipaddr, 16));
-    cmpre = cmpri;
+      /* How many bytes in common between all nodes in the path? */
+      cmpri = MIN(cmpri, count_matching_bytes(&node_addr, &UIP_IP_BUF->destipaddr, 16));
+      cmpre = cmpri;
 
-    LOG_DBG("SRH Hop ");
-    LOG_DBG_6ADDR(&node_addr);
-    LOG_DBG_("\n");
-    node = node->parent;
-    path_len++;
+      LOG_DBG("SRH Hop ");
+      LOG_DBG_6ADDR(&node_addr);
+      LOG_DBG_("\n");
+      node = node->parent;
+      path_len++;
+    }
   }
 
   /* Extension header length: fixed headers + (n-1) * (16-ComprI) + (16-ComprE)*/
@@ -402,22 +416,41 @@ insert_srh_header(void)
 
   /* Initialize addresses field (the actual source route).
    * From last to first. */
-  node = dest_node;
   hop_ptr = ((uint8_t *)rh_hdr) + ext_len - padding; /* Pointer where to write the next hop compressed address */
 
-  while(node != NULL && node->parent != root_node) {
+  if(cached != NULL) {
+    memcpy(hop_ptr - cached->addr_len, cached->addresses, cached->addr_len);
+    uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &cached->next_hop);
+  } else {
+    node = dest_node;
+    while(node != NULL && node->parent != root_node) {
+      NETSTACK_ROUTING.get_sr_node_ipaddr(&node_addr, node);
+
+      hop_ptr -= (16 - cmpri);
+      memcpy(hop_ptr, ((uint8_t*)&node_addr) + cmpri, 16 - cmpri);
+
+      node = node->parent;
+    }
+
+    /* The next hop (i.e. node whose parent is the root) */
     NETSTACK_ROUTING.get_sr_node_ipaddr(&node_addr, node);
 
-    hop_ptr -= (16 - cmpri);
-    memcpy(hop_ptr, ((uint8_t*)&node_addr) + cmpri, 16 - cmpri);
+    /* Cache the header for the next packets to this destination */
+    if(path_len * (16 - cmpri) <= UIP_SR_SRH_CACHE_ADDR_LEN) {
+      entry = uip_sr_srh_cache_add(dag, &UIP_IP_BUF->destipaddr);
+      if(entry != NULL) {
+        entry->path_len = path_len;
+        entry->cmpr = cmpri;
+        entry->addr_len = path_len * (16 - cmpri);
+        memcpy(entry->addresses, hop_ptr, entry->addr_len);
+        uip_ipaddr_copy(&entry->next_hop, &node_addr);
+      }
+    }
 
-    node = node->parent;
+    /* The next hop is placed as the current IPv6 destination */
+    uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &node_addr);
   }
 
-  /* The next hop (i.e. node whose parent is the root) is placed as the current IPv6 destination */
-  NETSTACK_ROUTING.get_sr_node_ipaddr(&node_addr, node);
-  uip_ipaddr_copy(&UIP_IP_BUF->destipaddr, &node_addr);
-
   /* Update the IPv6 length field */
   uipbuf_add_ext_hdr(ext_len);
   uipbuf_set_len_field(UIP_IP_BUF, uip_len - UIP_IPH_LEN);
@@ -168,10 +168,11 @@ int
 rpl_neighbor_count(void)
 {
   int count = 0;
-  rpl_nbr_t *nbr = nbr_table_head(rpl_neighbors);
-  for(nbr = nbr_table_head(rpl_neighbors);
+  nbr_table_iterator_t it;
+  rpl_nbr_t *nbr;
+  for(nbr = nbr_table_iterator_first(&it, rpl_neighbors);
       nbr != NULL;
-      nbr = nbr_table_next(rpl_neighbors, nbr)) {
+      nbr = nbr_table_iterator_next(&it)) {
     count++;
   }
   return count;
@@ -341,13 +342,14 @@ best_parent(int fresh_only)
 {
   rpl_nbr_t *nbr;
   rpl_nbr_t *best = NULL;
+  nbr_table_iterator_t it;
 
   if(curr_instance.used == 0) {
     return NULL;
   }
 
   /* Search for the best parent according to the OF */
-  for(nbr = nbr_table_head(rpl_neighbors); nbr != NULL; nbr = nbr_table_next(rpl_neighbors, nbr)) {
+  for(nbr = nbr_table_iterator_first(&it, rpl_neighbors); nbr != NULL; nbr = nbr_table_iterator_next(&it)) {
 
     if(!acceptable_rank(rpl_neighbor_rank_via_nbr(nbr))
       || !curr_instance.of->nbr_is_acceptable_parent(nbr)) {
@@ -43,6 +43,7 @@
 
 #include "net/routing/rpl-lite/rpl.h"
 #include "net/routing/routing.h"
+#include "net/ipv6/sicslowpan.h"
 
 /* Log configuration */
 #include "sys/log.h"
@@ -150,6 +151,9 @@ rpl_reset_prefix(rpl_prefix_t *last_prefix)
     uip_ds6_addr_rm(rep);
   }
   curr_instance.dag.prefix_info.length = 0;
+#if RPL_WITH_IPHC_CONTEXT
+  sicslowpan_addr_context_reset(0);
+#endif /* RPL_WITH_IPHC_CONTEXT */
 }
 /*---------------------------------------------------------------------------*/
 int
@@ -177,6 +181,9 @@ rpl_set_prefix_from_addr(uip_ipaddr_t *addr, unsigned len, uint8_t flags)
     LOG_INFO_("\n");
     uip_ds6_addr_add(&ipaddr, 0, ADDR_AUTOCONF);
   }
+#if RPL_WITH_IPHC_CONTEXT
+  sicslowpan_addr_context_set(0, &curr_instance.dag.prefix_info.prefix);
+#endif /* RPL_WITH_IPHC_CONTEXT */
   return 1;
 }
 /*---------------------------------------------------------------------------*/
@@ -0,0 +1,601 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A 6P scheduling function in the spirit of MSF (RFC 9033).
+ *
+ *         Differences with the RFC: autonomous cells are left to Orchestra,
+ *         only Tx cells to the parent are negotiated, one cell per
+ *         transaction, and no cell relocation is done.
+ */
+
+#include "contiki.h"
+#include "lib/random.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+#include "net/mac/tsch/sixtop/sixtop-conf.h"
+#include "net/mac/tsch/sixtop/sixp.h"
+#include "net/mac/tsch/sixtop/sixp-pkt.h"
+#include "net/mac/tsch/sixtop/sixp-trans.h"
+#include "msf.h"
+
+#include <string.h>
+
+/* Log configuration */
+#include "sys/log.h"
+#define LOG_MODULE "MSF"
+#define LOG_LEVEL LOG_LEVEL_MAC
+
+#if TSCH_WITH_LINK_SELECTOR && TSCH_LINK_SELECTOR_OPEN_SLOTFRAME != MSF_SLOTFRAME_HANDLE
+#error "With the TSCH link selector, set TSCH_CONF_LINK_SELECTOR_OPEN_SLOTFRAME to MSF_SLOTFRAME_HANDLE, or no packet will use the negotiated cells"
+#endif
+
+/* The length of the fixed part of ADD and DELETE requests: Metadata, CellOptions, and NumCells */
+#define MSF_REQ_HDR_LEN 4
+
+static struct tsch_slotframe *slotframe;
+static struct ctimer housekeeping_timer;
+
+/* The peer of the negotiated Tx cells */
+static linkaddr_t parent_addr;
+static uint8_t has_parent;
+
+/* Cell usage counters, updated from the TSCH interrupt */
+static volatile uint16_t num_cells_elapsed;
+static volatile uint16_t num_cells_used;
+
+static uint8_t req_storage[MSF_REQ_HDR_LEN +
+                           MSF_NUM_CANDIDATE_CELLS * SIXP_PKT_CELL_LEN];
+
+/* A response granting or releasing a cell. The schedule is updated once the
+ * response is sent. 6P allows one transaction per peer at a time, so there is
+ * one entry per peer with a transaction, up to SIXTOP_MAX_TRANSACTIONS */
+struct msf_response {
+  linkaddr_t peer_addr;
+  sixp_pkt_cmd_t cmd;
+  uint8_t in_use;
+  uint8_t cell[SIXP_PKT_CELL_LEN];
+};
+static struct msf_response responses[SIXTOP_MAX_TRANSACTIONS];
+
+/*---------------------------------------------------------------------------*/
+static uint16_t
+gcd(uint16_t a, uint16_t b)
+{
+  while(b != 0) {
+    uint16_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+/*---------------------------------------------------------------------------*/
+/* Is the timeslot of our slotframe taken, or granted in a response not sent
+ * yet? Links of other slotframes conflict if they coincide with it in every
+ * cycle, i.e. if both timeslots are equal modulo the GCD of the slotframe
+ * lengths. With coprime lengths, cells meet only once every few thousand
+ * slots, and TSCH then gives the slotframe with the lowest handle priority */
+static int
+is_timeslot_used(uint16_t timeslot)
+{
+  struct tsch_slotframe *sf;
+  struct tsch_link *l;
+  uint16_t i;
+
+  for(sf = tsch_schedule_slotframe_head(); sf != NULL;
+      sf = tsch_schedule_slotframe_next(sf)) {
+    uint16_t g = gcd(sf->size.val, MSF_SLOTFRAME_LENGTH);
+    if(g == 1 && sf != slotframe) {
+      continue;
+    }
+    for(l = list_head(sf->links_list); l != NULL; l = list_item_next(l)) {
+      if(l->timeslot % g == timeslot % g) {
+        return 1;
+      }
+    }
+  }
+
+  for(i = 0; i < SIXTOP_MAX_TRANSACTIONS; i++) {
+    if(responses[i].in_use && responses[i].cmd == SIXP_PKT_CMD_ADD) {
+      uint16_t pending_timeslot;
+      uint16_t pending_channel_offset;
+      sixp_pkt_read_cell(responses[i].cell, &pending_timeslot, &pending_channel_offset);
+      if(pending_timeslot == timeslot) {
+        return 1;
+      }
+    }
+  }
+  return 0;
+}
+/*---------------------------------------------------------------------------*/
+/* Get a response entry for a peer: its own, or a free one */
+static struct msf_response *
+response_alloc(const linkaddr_t *peer_addr)
+{
+  struct msf_response *free_res = NULL;
+  uint16_t i;
+
+  for(i = 0; i < SIXTOP_MAX_TRANSACTIONS; i++) {
+    if(!responses[i].in_use) {
+      if(free_res == NULL) {
+        free_res = &responses[i];
+      }
+    } else if(linkaddr_cmp(&responses[i].peer_addr, peer_addr)) {
+      /* A new request from this peer ends its previous transaction */
+      return &responses[i];
+    }
+  }
+  return free_res;
+}
+/*---------------------------------------------------------------------------*/
+static struct tsch_link *
+find_cell(const linkaddr_t *peer_addr, uint8_t link_options)
+{
+  struct tsch_link *l;
+  for(l = list_head(slotframe->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->link_options == link_options && linkaddr_cmp(&l->addr, peer_addr)) {
+      return l;
+    }
+  }
+  return NULL;
+}
+/*---------------------------------------------------------------------------*/
+static void
+remove_cells(const linkaddr_t *peer_addr, uint8_t link_options)
+{
+  struct tsch_link *l;
+  while((l = find_cell(peer_addr, link_options)) != NULL) {
+    tsch_schedule_remove_link(slotframe, l);
+  }
+}
+/*---------------------------------------------------------------------------*/
+int
+msf_get_num_tx_cells(void)
+{
+  struct tsch_link *l;
+  int count = 0;
+
+  if(slotframe == NULL || !has_parent) {
+    return 0;
+  }
+  for(l = list_head(slotframe->links_list); l != NULL; l = list_item_next(l)) {
+    if(l->link_options == LINK_OPTION_TX && linkaddr_cmp(&l->addr, &parent_addr)) {
+      count++;
+    }
+  }
+  return count;
+}
+/*---------------------------------------------------------------------------*/
+void
+msf_callback_tx_link_elapsed(const struct tsch_link *link, int is_used)
+{
+  if(has_parent
+     && link->slotframe_handle == MSF_SLOTFRAME_HANDLE
+     && linkaddr_cmp(&link->addr, &parent_addr)
+     && num_cells_elapsed < 0xffff) {
+    num_cells_elapsed++;
+    if(is_used) {
+      num_cells_used++;
+    }
+  }
+}
+/*---------------------------------------------------------------------------*/
+/* Get the CellList of the request being built in req_storage */
+static uint8_t *
+request_cell_list(sixp_pkt_cmd_t cmd)
+{
+  memset(req_storage, 0, sizeof(req_storage));
+  return sixp_pkt_get_cell_list_buf(SIXP_PKT_TYPE_REQUEST,
+                                    (sixp_pkt_code_t)(uint8_t)cmd,
+                                    sizeof(req_storage) - MSF_REQ_HDR_LEN,
+                                    req_storage, sizeof(req_storage));
+}
+/*---------------------------------------------------------------------------*/
+/* Send the request whose num_cells cells were written by the caller */
+static int
+send_request(sixp_pkt_cmd_t cmd, uint8_t num_cells)
+{
+  uint16_t req_len = MSF_REQ_HDR_LEN + num_cells * SIXP_PKT_CELL_LEN;
+
+  if(sixp_pkt_set_cell_options(SIXP_PKT_TYPE_REQUEST,
+                               (sixp_pkt_code_t)(uint8_t)cmd,
+                               SIXP_PKT_CELL_OPTION_TX,
+                               req_storage, sizeof(req_storage)) != 0 ||
+     sixp_pkt_set_num_cells(SIXP_PKT_TYPE_REQUEST,
+                            (sixp_pkt_code_t)(uint8_t)cmd,
+                            1,
+                            req_storage, sizeof(req_storage)) != 0) {
+    LOG_ERR("! build error on request %u\n", cmd);
+    return -1;
+  }
+
+  return sixp_output(SIXP_PKT_TYPE_REQUEST, (sixp_pkt_code_t)(uint8_t)cmd,
+                     MSF_SFID, req_storage, req_len, &parent_addr,
+                     NULL, NULL, 0);
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_add_request(void)
+{
+  uint8_t *cell_list = request_cell_list(SIXP_PKT_CMD_ADD);
+  uint16_t timeslots[MSF_NUM_CANDIDATE_CELLS];
+  uint8_t num_cells = 0;
+  int tries;
+  int i;
+
+  if(cell_list == NULL) {
+    return -1;
+  }
+
+  /* Pick random unused slot offsets; timeslot 0 is left alone */
+  for(tries = 0; tries < 4 * MSF_NUM_CANDIDATE_CELLS
+        && num_cells < MSF_NUM_CANDIDATE_CELLS; tries++) {
+    uint16_t timeslot = 1 + random_rand() % (MSF_SLOTFRAME_LENGTH - 1);
+    uint16_t channel_offset = random_rand() % tsch_hopping_sequence_length.val;
+
+    if(is_timeslot_used(timeslot)) {
+      continue;
+    }
+    for(i = 0; i < num_cells; i++) {
+      if(timeslots[i] == timeslot) {
+        break;
+      }
+    }
+    if(i < num_cells) {
+      continue;
+    }
+    timeslots[num_cells] = timeslot;
+    sixp_pkt_write_cell(&cell_list[num_cells * SIXP_PKT_CELL_LEN],
+                        timeslot, channel_offset);
+    num_cells++;
+  }
+
+  if(num_cells == 0) {
+    return -1;
+  }
+
+  LOG_INFO("requesting a cell from ");
+  LOG_INFO_LLADDR(&parent_addr);
+  LOG_INFO_(", %u candidates\n", num_cells);
+  return send_request(SIXP_PKT_CMD_ADD, num_cells);
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_delete_request(void)
+{
+  uint8_t *cell_list;
+  struct tsch_link *l = find_cell(&parent_addr, LINK_OPTION_TX);
+
+  if(l == NULL || (cell_list = request_cell_list(SIXP_PKT_CMD_DELETE)) == NULL) {
+    return -1;
+  }
+
+  sixp_pkt_write_cell(cell_list, l->timeslot, l->channel_offset);
+  LOG_INFO("releasing cell %u/%u to ", l->timeslot, l->channel_offset);
+  LOG_INFO_LLADDR(&parent_addr);
+  LOG_INFO_("\n");
+  return send_request(SIXP_PKT_CMD_DELETE, 1);
+}
+/*---------------------------------------------------------------------------*/
+static int
+send_clear_request(const linkaddr_t *peer_addr)
+{
+  memset(req_storage, 0, sizeof(sixp_pkt_metadata_t));
+  return sixp_output(SIXP_PKT_TYPE_REQUEST,
+                     (sixp_pkt_code_t)(uint8_t)SIXP_PKT_CMD_CLEAR,
+                     MSF_SFID, req_storage, sizeof(sixp_pkt_metadata_t), peer_addr,
+                     NULL, NULL, 0);
+}
+/*---------------------------------------------------------------------------*/
+static void
+set_parent(const linkaddr_t *new_parent)
+{
+  if(has_parent) {
+    /* Drop the cells to the old parent, and let it know if still possible */
+    remove_cells(&parent_addr, LINK_OPTION_TX);
+    if(tsch_is_associated && sixp_trans_find(&parent_addr) == NULL) {
+      send_clear_request(&parent_addr);
+    }
+  }
+
+  has_parent = new_parent != NULL;
+  if(has_parent) {
+    linkaddr_copy(&parent_addr, new_parent);
+  }
+  num_cells_elapsed = 0;
+  num_cells_used = 0;
+}
+/*---------------------------------------------------------------------------*/
+static void
+housekeeping(void *ptr)
+{
+  struct tsch_neighbor *n;
+  int num_tx_cells;
+
+  ctimer_reset(&housekeeping_timer);
+
+  if(!tsch_is_associated) {
+    if(has_parent) {
+      set_parent(NULL);
+    }
+    return;
+  }
+
+  n = tsch_queue_get_time_source();
+  if(n == NULL) {
+    /* TSCH is busy, or we are the coordinator */
+    return;
+  }
+  if(!has_parent || !linkaddr_cmp(&parent_addr, tsch_queue_get_nbr_address(n))) {
+    set_parent(tsch_queue_get_nbr_address(n));
+  }
+
+  if(sixp_trans_find(&parent_addr) != NULL) {
+    /* A transaction is ongoing */
+    return;
+  }
+
+  num_tx_cells = msf_get_num_tx_cells();
+  if(num_cells_elapsed >= MSF_MAX_NUM_CELLS) {
+    uint16_t usage = (uint32_t)num_cells_used * 100 / num_cells_elapsed;
+
+    LOG_DBG("%u/%u cells used, %d negotiated\n",
+            num_cells_used, num_cells_elapsed, num_tx_cells);
+    num_cells_elapsed = 0;
+    num_cells_used = 0;
+
+    if(usage > MSF_LIM_NUM_CELLS_USED_HIGH) {
+      if(num_tx_cells < MSF_MAX_NEGOTIATED_CELLS) {
+        send_add_request();
+      }
+    } else if(usage < MSF_LIM_NUM_CELLS_USED_LOW) {
+      send_delete_request();
+    }
+  } else if(num_tx_cells == 0
+            && tsch_queue_nbr_packet_count(n) >= MSF_QUEUE_THRESHOLD) {
+    /* The autonomous cells do not keep up; no negotiated cell to measure yet */
+    send_add_request();
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_sent_callback(void *arg, uint16_t arg_len,
+                       const linkaddr_t *dest_addr,
+                       sixp_output_status_t status)
+{
+  struct msf_response *res = (struct msf_response *)arg;
+  uint16_t timeslot;
+  uint16_t channel_offset;
+
+  if(res == NULL || !res->in_use) {
+    return;
+  }
+  res->in_use = 0;
+
+  if(status != SIXP_OUTPUT_STATUS_SUCCESS) {
+    return;
+  }
+
+  sixp_pkt_read_cell(res->cell, &timeslot, &channel_offset);
+  if(res->cmd == SIXP_PKT_CMD_ADD) {
+    tsch_schedule_add_link(slotframe, LINK_OPTION_RX, LINK_TYPE_NORMAL, dest_addr,
+                           timeslot, channel_offset, 1);
+  } else {
+    tsch_schedule_remove_link_by_timeslot(slotframe, timeslot, channel_offset);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+request_input(sixp_pkt_cmd_t cmd, const uint8_t *body, uint16_t body_len,
+              const linkaddr_t *peer_addr)
+{
+  sixp_pkt_cell_options_t cell_options;
+  const uint8_t *cell_list;
+  uint16_t cell_list_len;
+  struct msf_response *res;
+  uint16_t timeslot;
+  uint16_t channel_offset;
+  uint16_t i;
+
+  if(cmd == SIXP_PKT_CMD_CLEAR) {
+    remove_cells(peer_addr, LINK_OPTION_RX);
+    sixp_output(SIXP_PKT_TYPE_RESPONSE,
+                (sixp_pkt_code_t)(uint8_t)SIXP_PKT_RC_SUCCESS, MSF_SFID,
+                NULL, 0, peer_addr, NULL, NULL, 0);
+    return;
+  }
+
+  if((cmd != SIXP_PKT_CMD_ADD && cmd != SIXP_PKT_CMD_DELETE) ||
+     sixp_pkt_get_cell_options(SIXP_PKT_TYPE_REQUEST, (sixp_pkt_code_t)(uint8_t)cmd,
+                               &cell_options, body, body_len) != 0 ||
+     sixp_pkt_get_cell_list(SIXP_PKT_TYPE_REQUEST, (sixp_pkt_code_t)(uint8_t)cmd,
+                            &cell_list, &cell_list_len, body, body_len) != 0 ||
+     cell_options != SIXP_PKT_CELL_OPTION_TX) {
+    /* Only Tx cells of the requester are supported */
+    sixp_output(SIXP_PKT_TYPE_RESPONSE,
+                (sixp_pkt_code_t)(uint8_t)SIXP_PKT_RC_ERR, MSF_SFID,
+                NULL, 0, peer_addr, NULL, NULL, 0);
+    return;
+  }
+
+  res = response_alloc(peer_addr);
+  if(res == NULL) {
+    /* Already answering as many peers as we have transactions */
+    sixp_output(SIXP_PKT_TYPE_RESPONSE,
+                (sixp_pkt_code_t)(uint8_t)SIXP_PKT_RC_ERR_BUSY, MSF_SFID,
+                NULL, 0, peer_addr, NULL, NULL, 0);
+    return;
+  }
+  /* Free the entry while looking for a cell, so that a previous
+   * response to this peer does not block its timeslot */
+  res->in_use = 0;
+
+  /* Select the first usable cell. For ADD, one whose timeslot is free here;
+   * for DELETE, one we have with this peer. */
+  for(i = 0; i + SIXP_PKT_CELL_LEN <= cell_list_len; i += SIXP_PKT_CELL_LEN) {
+    sixp_pkt_read_cell(&cell_list[i], &timeslot, &channel_offset);
+    if(cmd == SIXP_PKT_CMD_ADD) {
+      if(timeslot < MSF_SLOTFRAME_LENGTH && !is_timeslot_used(timeslot)) {
+        break;
+      }
+    } else {
+      struct tsch_link *l = tsch_schedule_get_link_by_timeslot(slotframe,
+                                                               timeslot, channel_offset);
+      if(l != NULL && linkaddr_cmp(&l->addr, peer_addr)) {
+        break;
+      }
+    }
+  }
+  if(i + SIXP_PKT_CELL_LEN > cell_list_len) {
+    /* No usable cell: empty CellList */
+    sixp_output(SIXP_PKT_TYPE_RESPONSE,
+                (sixp_pkt_code_t)(uint8_t)SIXP_PKT_RC_SUCCESS, MSF_SFID,
+                NULL, 0, peer_addr, NULL, NULL, 0);
+    return;
+  }
+
+  /* The schedule is updated once the response is sent */
+  linkaddr_copy(&res->peer_addr, peer_addr);
+  res->cmd = cmd;
+  sixp_pkt_write_cell(res->cell, timeslot, channel_offset);
+  res->in_use = 1;
+  if(sixp_output(SIXP_PKT_TYPE_RESPONSE,
+                 (sixp_pkt_code_t)(uint8_t)SIXP_PKT_RC_SUCCESS, MSF_SFID,
+                 res->cell, sizeof(res->cell), peer_addr,
+                 response_sent_callback, res, sizeof(*res)) != 0) {
+    res->in_use = 0;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+response_input(sixp_pkt_rc_t rc, const uint8_t *body, uint16_t body_len,
+               const linkaddr_t *peer_addr)
+{
+  const uint8_t *cell_list;
+  uint16_t cell_list_len;
+  uint16_t timeslot;
+  uint16_t channel_offset;
+  sixp_pkt_cmd_t cmd;
+  sixp_trans_t *trans = sixp_trans_find(peer_addr);
+
+  if(trans == NULL) {
+    return;
+  }
+
+  cmd = sixp_trans_get_cmd(trans);
+  if(rc != SIXP_PKT_RC_SUCCESS) {
+    LOG_WARN("! request %u refused by ", cmd);
+    LOG_WARN_LLADDR(peer_addr);
+    LOG_WARN_(", rc %u\n", rc);
+    return;
+  }
+
+  if((cmd != SIXP_PKT_CMD_ADD && cmd != SIXP_PKT_CMD_DELETE) ||
+     sixp_pkt_get_cell_list(SIXP_PKT_TYPE_RESPONSE,
+                            (sixp_pkt_code_t)(uint8_t)SIXP_PKT_RC_SUCCESS,
+                            &cell_list, &cell_list_len, body, body_len) != 0 ||
+     cell_list_len < SIXP_PKT_CELL_LEN) {
+    /* Nothing to do: CLEAR response, or no cell granted */
+    return;
+  }
+
+  sixp_pkt_read_cell(cell_list, &timeslot, &channel_offset);
+  if(cmd == SIXP_PKT_CMD_ADD) {
+    LOG_INFO("got cell %u/%u to ", timeslot, channel_offset);
+    LOG_INFO_LLADDR(peer_addr);
+    LOG_INFO_("\n");
+    tsch_schedule_add_link(slotframe, LINK_OPTION_TX, LINK_TYPE_NORMAL, peer_addr,
+                           timeslot, channel_offset, 1);
+  } else {
+    tsch_schedule_remove_link_by_timeslot(slotframe, timeslot, channel_offset);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+input(sixp_pkt_type_t type, sixp_pkt_code_t code,
+      const uint8_t *body, uint16_t body_len, const linkaddr_t *src_addr)
+{
+  if(slotframe == NULL) {
+    return;
+  }
+
+  switch(type) {
+    case SIXP_PKT_TYPE_REQUEST:
+      request_input(code.cmd, body, body_len, src_addr);
+      break;
+    case SIXP_PKT_TYPE_RESPONSE:
+      response_input(code.rc, body, body_len, src_addr);
+      break;
+    default:
+      /* unsupported */
+      break;
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+error(sixp_error_t err, sixp_pkt_cmd_t cmd, uint8_t seqno,
+      const linkaddr_t *peer_addr)
+{
+  LOG_WARN("! 6P error %u on cmd %u with ", err, cmd);
+  LOG_WARN_LLADDR(peer_addr);
+  LOG_WARN_("\n");
+
+  if(err == SIXP_ERROR_SCHEDULE_INCONSISTENCY) {
+    /* Start over with this peer */
+    remove_cells(peer_addr, LINK_OPTION_TX);
+    remove_cells(peer_addr, LINK_OPTION_RX);
+  }
+}
+/*---------------------------------------------------------------------------*/
+static void
+init(void)
+{
+  slotframe = tsch_schedule_get_slotframe_by_handle(MSF_SLOTFRAME_HANDLE);
+  if(slotframe == NULL) {
+    slotframe = tsch_schedule_add_slotframe(MSF_SLOTFRAME_HANDLE, MSF_SLOTFRAME_LENGTH);
+  }
+  has_parent = 0;
+  memset(responses, 0, sizeof(responses));
+  num_cells_elapsed = 0;
+  num_cells_used = 0;
+  ctimer_set(&housekeeping_timer, MSF_HOUSEKEEPING_PERIOD, housekeeping, NULL);
+}
+/*---------------------------------------------------------------------------*/
+const sixtop_sf_t msf_driver = {
+  MSF_SFID,
+  CLOCK_SECOND * 5,
+  init,
+  input,
+  NULL,
+  error
+};
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         A 6P scheduling function in the spirit of MSF (RFC 9033).
+ *         Negotiates dedicated Tx cells to the time source (RPL parent)
+ *         when the cells it already has are mostly used, or when packets
+ *         queue up with none negotiated, and releases them when idle.
+ *         Meant to run next to Orchestra's autonomous cells.
+ */
+
+#ifndef __MSF_H__
+#define __MSF_H__
+
+#include "contiki.h"
+#include "net/mac/tsch/tsch.h"
+#include "net/mac/tsch/sixtop/sixtop.h"
+
+/* The SFID; 0 is the one assigned to MSF */
+#ifdef MSF_CONF_SFID
+#define MSF_SFID MSF_CONF_SFID
+#else
+#define MSF_SFID 0
+#endif
+
+/* The handle of the slotframe with the negotiated cells. Must not collide
+ * with Orchestra: Orchestra uses the rule index as slotframe handle */
+#ifdef MSF_CONF_SLOTFRAME_HANDLE
+#define MSF_SLOTFRAME_HANDLE MSF_CONF_SLOTFRAME_HANDLE
+#else
+#define MSF_SLOTFRAME_HANDLE 5
+#endif
+
+/* The length of the slotframe with the negotiated cells */
+#ifdef MSF_CONF_SLOTFRAME_LENGTH
+#define MSF_SLOTFRAME_LENGTH MSF_CONF_SLOTFRAME_LENGTH
+#else
+#define MSF_SLOTFRAME_LENGTH 101
+#endif
+
+/* The maximal number of cells negotiated with the parent */
+#ifdef MSF_CONF_MAX_NEGOTIATED_CELLS
+#define MSF_MAX_NEGOTIATED_CELLS MSF_CONF_MAX_NEGOTIATED_CELLS
+#else
+#define MSF_MAX_NEGOTIATED_CELLS 4
+#endif
+
+/* The number of negotiated cells that must elapse before their usage is evaluated */
+#ifdef MSF_CONF_MAX_NUM_CELLS
+#define MSF_MAX_NUM_CELLS MSF_CONF_MAX_NUM_CELLS
+#else
+#define MSF_MAX_NUM_CELLS 16
+#endif
+
+/* Add a cell if more than this percentage of the negotiated cells is used */
+#ifdef MSF_CONF_LIM_NUM_CELLS_USED_HIGH
+#define MSF_LIM_NUM_CELLS_USED_HIGH MSF_CONF_LIM_NUM_CELLS_USED_HIGH
+#else
+#define MSF_LIM_NUM_CELLS_USED_HIGH 75
+#endif
+
+/* Delete a cell if less than this percentage of the negotiated cells is used */
+#ifdef MSF_CONF_LIM_NUM_CELLS_USED_LOW
+#define MSF_LIM_NUM_CELLS_USED_LOW MSF_CONF_LIM_NUM_CELLS_USED_LOW
+#else
+#define MSF_LIM_NUM_CELLS_USED_LOW 25
+#endif
+
+/* Negotiate the first cell once this many packets wait for the parent */
+#ifdef MSF_CONF_QUEUE_THRESHOLD
+#define MSF_QUEUE_THRESHOLD MSF_CONF_QUEUE_THRESHOLD
+#else
+#define MSF_QUEUE_THRESHOLD 3
+#endif
+
+/* The number of candidate cells proposed in an ADD request */
+#ifdef MSF_CONF_NUM_CANDIDATE_CELLS
+#define MSF_NUM_CANDIDATE_CELLS MSF_CONF_NUM_CANDIDATE_CELLS
+#else
+#define MSF_NUM_CANDIDATE_CELLS 5
+#endif
+
+/* How often to check the queue and cell usage */
+#ifdef MSF_CONF_HOUSEKEEPING_PERIOD
+#define MSF_HOUSEKEEPING_PERIOD MSF_CONF_HOUSEKEEPING_PERIOD
+#else
+#define MSF_HOUSEKEEPING_PERIOD (2 * CLOCK_SECOND)
+#endif
+
+/* The scheduling function driver, to be added with sixtop_add_sf() */
+extern const sixtop_sf_t msf_driver;
+
+/**
+ * \brief Get the number of Tx cells currently negotiated with the parent
+ * \return The number of cells
+ */
+int msf_get_num_tx_cells(void);
+
+/* Set with #define TSCH_CALLBACK_TX_LINK_ELAPSED msf_callback_tx_link_elapsed */
+void msf_callback_tx_link_elapsed(const struct tsch_link *link, int is_used);
+
+#endif /* __MSF_H__ */
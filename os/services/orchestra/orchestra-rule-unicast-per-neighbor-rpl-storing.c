@@ -94,7 +94,7 @@ neighbor_has_uc_link(const linkaddr_t *linkaddr)
        && linkaddr_cmp(&orchestra_parent_linkaddr, linkaddr)) {
       return 1;
     }
-    if(nbr_table_get_from_lladdr(nbr_routes, (linkaddr_t *)linkaddr) != NULL) {
+    if(uip_ds6_route_num_routes_via((const uip_lladdr_t *)linkaddr) > 0) {
       return 1;
     }
   }
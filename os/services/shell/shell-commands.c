@@ -614,9 +614,62 @@ PT_THREAD(cmd_tsch_status(struct pt *pt, shell_output_func output, char *args))
     SHELL_OUTPUT(output, "-- Network uptime: %lu seconds\n",
                  (unsigned long)(tsch_get_network_uptime_ticks() / CLOCK_SECOND));
   }
+#if TSCH_STATS_ON
+  SHELL_OUTPUT(output, "-- Input queue: max %u/%u, %u drops\n",
+               tsch_stats.input_queue_max_len, TSCH_MAX_INCOMING_PACKETS,
+               tsch_stats.input_queue_drops);
+#endif /* TSCH_STATS_ON */
 
   PT_END(pt);
 }
+#if TSCH_PROFILE_ON
+/*---------------------------------------------------------------------------*/
+static
+PT_THREAD(cmd_tsch_profile(struct pt *pt, shell_output_func output, char *args))
+{
+  char *next_args;
+  int phase;
+  int bin;
+
+  PT_BEGIN(pt);
+
+  SHELL_ARGS_INIT(args, next_args);
+
+  /* Get first arg (optional "reset") */
+  SHELL_ARGS_NEXT(args, next_args);
+  if(args != NULL && strcmp(args, "reset")) {
+    SHELL_OUTPUT(output, "Invalid argument: %s\n", args);
+    PT_EXIT(pt);
+  }
+
+  SHELL_OUTPUT(output, "TSCH slot profile (us), histogram bins from %u us:\n",
+               TSCH_PROFILE_FIRST_BIN_US);
+  for(phase = 0; phase < TSCH_PROFILE_PHASE_COUNT; phase++) {
+    const struct tsch_profile_stats *stats = tsch_profile_get(phase);
+    SHELL_OUTPUT(output, "-- %-15s n %5u", tsch_profile_phase_name(phase), stats->count);
+    if(stats->count > 0) {
+      SHELL_OUTPUT(output, ", min %5lu, mean %5lu, max %5lu |",
+                   (unsigned long)RTIMERTICKS_TO_US(stats->min),
+                   (unsigned long)RTIMERTICKS_TO_US(stats->sum / stats->count),
+                   (unsigned long)RTIMERTICKS_TO_US(stats->max));
+      for(bin = 0; bin < TSCH_PROFILE_HISTOGRAM_BINS; bin++) {
+        SHELL_OUTPUT(output, " %u", stats->histogram[bin]);
+      }
+      if(stats->count == TSCH_PROFILE_COUNT_MAX) {
+        SHELL_OUTPUT(output, " (saturated, reset to resume)");
+      }
+    }
+    SHELL_OUTPUT(output, "\n");
+  }
+
+  if(args != NULL) {
+    tsch_profile_reset();
+    SHELL_OUTPUT(output, "Profile reset\n");
+  }
+
+  PT_END(pt);
+}
+#endif /* TSCH_PROFILE_ON */
 #endif /* MAC_CONF_WITH_TSCH */
 #if NETSTACK_CONF_WITH_IPV6
 /*---------------------------------------------------------------------------*/
@@ -1007,6 +1060,9 @@ const struct shell_command_t builtin_shell_commands[] = {
   { "tsch-set-coordinator", cmd_tsch_set_coordinator, "'> tsch-set-coordinator 0/1 [0/1]': Sets node as coordinator (1) or not (0). Second, optional parameter: enable (1) or disable (0) security." },
   { "tsch-schedule",        cmd_tsch_schedule,        "'> tsch-schedule': Shows the current TSCH schedule" },
   { "tsch-status",          cmd_tsch_status,          "'> tsch-status': Shows a summary of the current TSCH state" },
+#if TSCH_PROFILE_ON
+  { "tsch-profile",         cmd_tsch_profile,         "'> tsch-profile [reset]': Shows per-phase slot timing statistics, and optionally resets them" },
+#endif /* TSCH_PROFILE_ON */
 #endif /* MAC_CONF_WITH_TSCH */
 #if TSCH_WITH_SIXTOP
   { "6top",                 cmd_6top,                 "'> 6top help': Shows 6top command usage" },
@@ -45,9 +45,6 @@
 
 /*---------------------------------------------------------------------------*/
 
-/* Allow to change only 1 channel at once */
-#define TSCH_CS_MAX_CHANNELS_CHANGED 1
-
 /* Do not up change channels more frequently than this */
 #define TSCH_CS_MIN_UPDATE_INTERVAL_SEC 60
 
@@ -73,13 +70,6 @@ static tsch_cs_bitmap_t tsch_cs_initial_bitmap;
 /* The bitmap with the current channels */
 static tsch_cs_bitmap_t tsch_cs_current_bitmap;
 
-/* structure for sorting */
-struct tsch_cs_quality {
-  /* channel number */
-  uint8_t channel;
-  /* the higher, the better */
-  tsch_stat_t metric;
-};
 /*---------------------------------------------------------------------------*/
 static inline bool
 tsch_cs_bitmap_contains(tsch_cs_bitmap_t bitmap, uint8_t channel)
@@ -111,65 +101,100 @@ tsch_cs_adaptations_init(void)
   tsch_cs_current_bitmap = tsch_cs_initial_bitmap;
 }
 /*---------------------------------------------------------------------------*/
-/* Sort the elements to that the channels with the best metrics are in the front */
-static void
-tsch_cs_bubble_sort(struct tsch_cs_quality *qualities)
+static tsch_stat_t
+tsch_cs_best_p_tx(void)
 {
-  int i, j;
-  struct tsch_cs_quality tmp;
+  int i;
+  tsch_stat_t best_p_tx = 0;
 
   for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
-    for(j = 0; j + 1 < TSCH_STATS_NUM_CHANNELS; ++j) {
-      if(qualities[j].metric < qualities[j+1].metric){
-        tmp = qualities[j];
-        qualities[j] = qualities[j+1];
-        qualities[j+1] = tmp;
-      }
+    if(tsch_stats.channel_p_tx_success[i] > best_p_tx) {
+      best_p_tx = tsch_stats.channel_p_tx_success[i];
+    }
+  }
+  return best_p_tx;
+}
+/*---------------------------------------------------------------------------*/
+/* Channel quality: the fraction of time the channel is free, weighted by
+ * the unicast Tx success rate on it relative to the best channel. The
+ * relative PRR is used because link quality to the neighbors is a property
+ * of the neighborhood as well; only the difference between channels matters. */
+static tsch_stat_t
+tsch_cs_channel_quality(uint8_t index, tsch_stat_t best_p_tx)
+{
+  uint32_t relative_p_tx = TSCH_STATS_BINARY_SCALING_FACTOR;
+
+  if(best_p_tx != 0) {
+    relative_p_tx = (uint32_t)tsch_stats.channel_p_tx_success[index]
+      * TSCH_STATS_BINARY_SCALING_FACTOR / best_p_tx;
+    if(relative_p_tx > TSCH_STATS_BINARY_SCALING_FACTOR) {
+      relative_p_tx = TSCH_STATS_BINARY_SCALING_FACTOR;
     }
   }
+
+  return (tsch_stat_t)((uint32_t)tsch_stats.channel_free_ewma[index]
+                       * relative_p_tx / TSCH_STATS_BINARY_SCALING_FACTOR);
 }
 /*---------------------------------------------------------------------------*/
-/* Select a single, currently unused, good enough channel. Returns 0xff on failure. */
+/* Select the worst channel in the current hopping sequence, if it is busy.
+ * Returns 0xff if none of the channels in use is busy. */
 static uint8_t
-tsch_cs_select_replacement(uint8_t old_channel, tsch_stat_t old_ewma,
-                      struct tsch_cs_quality *qualities, uint8_t is_in_sequence[])
+tsch_cs_select_worst(const tsch_stat_t *qualities)
 {
   int i;
+  uint8_t worst = 0xff;
+
+  for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
+    uint8_t channel = tsch_stats_index_to_channel(i);
+    if(!tsch_cs_bitmap_contains(tsch_cs_current_bitmap, channel)
+       || qualities[i] >= TSCH_CS_FREE_THRESHOLD) {
+      continue;
+    }
+    if(worst == 0xff || qualities[i] < qualities[worst]) {
+      worst = i;
+    }
+  }
+
+  return worst == 0xff ? 0xff : tsch_stats_index_to_channel(worst);
+}
+/*---------------------------------------------------------------------------*/
+/* Select the best currently unused, good enough channel. Returns 0xff on failure. */
+static uint8_t
+tsch_cs_select_replacement(uint8_t old_channel, const tsch_stat_t *qualities)
+{
+  int i;
+  uint8_t best = 0xff;
   uint32_t now = clock_seconds();
   tsch_cs_bitmap_t bitmap = tsch_cs_bitmap_set(0, old_channel);
-
   /* Don't want to replace a channel if the improvement is miniscule (< 10%) */
-  old_ewma += TSCH_CS_HYSTERESIS;
-
-  /* iterate up to -1 because we know that at least one of the channels is bad */
-  for(i = 0; i < TSCH_STATS_NUM_CHANNELS - 1; ++i) {
-    /* select a replacement candidate */
-    uint8_t candidate = qualities[i].channel;
-
-    if(qualities[i].metric < TSCH_CS_FREE_THRESHOLD) {
-      /* This channel is not good enough.
-       * since we know that the other channels in the sorted list are even worse,
-       * it makes sense to return immediately rather than to continue t
-       */
-      LOG_DBG("ch %u: busy\n", candidate);
-      return 0xff;
+  uint32_t min_quality = (uint32_t)qualities[tsch_stats_channel_to_index(old_channel)]
+    + TSCH_CS_HYSTERESIS;
+
+  if(min_quality < TSCH_CS_FREE_THRESHOLD) {
+    min_quality = TSCH_CS_FREE_THRESHOLD;
+  }
+
+  for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
+    uint8_t candidate = tsch_stats_index_to_channel(i);
+
+    if(qualities[i] < min_quality) {
+      /* busy, or not good enough to replace */
+      continue;
     }
 
-    if(qualities[i].metric < old_ewma) {
-      /* not good enough to replace */
-      LOG_DBG("ch %u: hysteresis check failed\n", candidate);
-      return 0xff;
+    if(best != 0xff && qualities[i] <= qualities[best]) {
+      /* already have a better one */
+      continue;
     }
 
     /* already in the current TSCH hopping sequence? */
-    if(is_in_sequence[candidate - TSCH_STATS_FIRST_CHANNEL] != 0xff) {
-      LOG_DBG("ch %u: in seq\n", candidate);
+    if(tsch_cs_bitmap_contains(tsch_cs_current_bitmap, candidate)) {
       continue;
     }
 
     /* ignore this candidate if too recently blacklisted */
-    if(tsch_cs_busy_since[candidate - TSCH_STATS_FIRST_CHANNEL] != 0
-        && tsch_cs_busy_since[candidate - TSCH_STATS_FIRST_CHANNEL] + TSCH_CS_BLACKLIST_DURATION_SEC > now) {
+    if(tsch_cs_busy_since[i] != 0
+        && tsch_cs_busy_since[i] + TSCH_CS_BLACKLIST_DURATION_SEC > now) {
       LOG_DBG("ch %u: recent bl\n", candidate);
       continue;
     }
@@ -183,21 +208,19 @@ tsch_cs_select_replacement(uint8_t old_channel, tsch_stat_t old_ewma,
       }
     }
 
-    return candidate;
+    best = i;
   }
 
-  return 0xff;
+  return best == 0xff ? 0xff : tsch_stats_index_to_channel(best);
 }
 /*---------------------------------------------------------------------------*/
 bool
 tsch_cs_process(void)
 {
   int i;
-  bool try_replace;
-  bool has_replaced;
-  struct tsch_cs_quality qualities[TSCH_STATS_NUM_CHANNELS];
-  uint8_t is_channel_busy[TSCH_STATS_NUM_CHANNELS];
-  uint8_t is_in_sequence[TSCH_STATS_NUM_CHANNELS];
+  int num_replaced;
+  tsch_stat_t best_p_tx;
+  tsch_stat_t qualities[TSCH_STATS_NUM_CHANNELS];
   static uint32_t last_time_changed;
 
   if(!recaculation_requested) {
@@ -213,77 +236,51 @@ tsch_cs_process(void)
   /* reset the flag */
   recaculation_requested = false;
 
+  best_p_tx = tsch_cs_best_p_tx();
   for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
-    qualities[i].channel = i + TSCH_STATS_FIRST_CHANNEL;
-    qualities[i].metric = tsch_stats.channel_free_ewma[i];
-  }
-
-  /* bubble sort the channels */
-  tsch_cs_bubble_sort(qualities);
-
-  /* start with the threshold values */
-  for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
-    is_channel_busy[i] = (tsch_stats.channel_free_ewma[i] < TSCH_CS_FREE_THRESHOLD);
-  }
-  memset(is_in_sequence, 0xff, sizeof(is_in_sequence));
-  for(i = 0; i < tsch_hopping_sequence_length.val; ++i) {
-    uint8_t channel = tsch_hopping_sequence[i];
-    is_in_sequence[channel - TSCH_STATS_FIRST_CHANNEL] = i;
+    qualities[i] = tsch_cs_channel_quality(i, best_p_tx);
+    LOG_DBG("ch %u q %u free %u p_tx %u in seq %u\n",
+        tsch_stats_index_to_channel(i),
+        qualities[i],
+        tsch_stats.channel_free_ewma[i],
+        tsch_stats.channel_p_tx_success[i],
+        tsch_cs_bitmap_contains(tsch_cs_current_bitmap, tsch_stats_index_to_channel(i)));
   }
 
-  /* mark the first N channels as "good" - there is nothing better to select */
-  for(i = 0; i < tsch_hopping_sequence_length.val; ++i) {
-     is_channel_busy[qualities[i].channel - TSCH_STATS_FIRST_CHANNEL] = 0;
-  }
+  /* replace the worst busy channels, one by one, while there are better ones available */
+  for(num_replaced = 0; num_replaced < TSCH_CS_MAX_CHANNELS_CHANGED; ++num_replaced) {
+    uint8_t channel = tsch_cs_select_worst(qualities);
+    uint8_t replacement;
 
-  for(i = 0; i < TSCH_STATS_NUM_CHANNELS; ++i) {
-    uint8_t ci = qualities[i].channel - TSCH_STATS_FIRST_CHANNEL;
-    (void)ci;
-    LOG_DBG("ch %u q %u busy %u in seq %u\n",
-        qualities[i].channel,
-        qualities[i].metric,
-        is_channel_busy[ci],
-        is_in_sequence[ci] == 0xff ? 0 : 1);
-  }
+    if(channel == 0xff) {
+      LOG_DBG("cs: not replacing\n");
+      break;
+    }
 
-  try_replace = false;
-  for(i = 0; i < tsch_hopping_sequence_length.val; ++i) {
-    uint8_t channel = tsch_hopping_sequence[i];
-    if(is_channel_busy[channel - TSCH_STATS_FIRST_CHANNEL]) {
-      try_replace = true;
+    replacement = tsch_cs_select_replacement(channel, qualities);
+    if(replacement == 0xff) {
+      LOG_DBG("cs: no replacement for ch %u\n", channel);
+      break;
     }
-  }
-  if(!try_replace) {
-    LOG_DBG("cs: not replacing\n");
-    return false;
-  }
 
-  has_replaced = false;
-  for(i = TSCH_STATS_NUM_CHANNELS - 1; i >= tsch_hopping_sequence_length.val; --i) {
-    if(is_in_sequence[qualities[i].channel - TSCH_STATS_FIRST_CHANNEL] != 0xff) {
-      /* found the worst channel; it must be busy */
-      uint8_t channel = qualities[i].channel;
-      tsch_stat_t ewma_metric = qualities[i].metric;
-      uint8_t replacement = tsch_cs_select_replacement(channel, ewma_metric,
-                                                  qualities, is_in_sequence);
-      uint8_t position = is_in_sequence[channel - TSCH_STATS_FIRST_CHANNEL];
-
-      if(replacement != 0xff) {
-        printf("\ncs: replacing channel %u %u (%u) with %u\n",
-               channel, tsch_hopping_sequence[position], position, replacement);
-        /* mark the old channel as busy */
-        tsch_cs_busy_since[channel - TSCH_STATS_FIRST_CHANNEL] = clock_seconds();
-        /* do the actual replacement in the global TSCH HS variable */
-        tsch_hopping_sequence[position] = replacement;
-        has_replaced = true;
-        /* recalculate the hopping sequence bitmap */
-        tsch_cs_current_bitmap = tsch_cs_bitmap_calc();
+    LOG_INFO("replacing channel %u with %u\n", channel, replacement);
+    /* mark the old channel as busy */
+    tsch_cs_busy_since[tsch_stats_channel_to_index(channel)] = clock_seconds();
+    /* do the actual replacement in the global TSCH HS variable */
+    for(i = 0; i < tsch_hopping_sequence_length.val; ++i) {
+      if(tsch_hopping_sequence[i] == channel) {
+        tsch_hopping_sequence[i] = replacement;
       }
-      break; /* replace just one at once */
     }
+    tsch_set_hopping_sequence(tsch_hopping_sequence, tsch_hopping_sequence_length.val);
+    /* recalculate the hopping sequence bitmap */
+    tsch_cs_current_bitmap = tsch_cs_bitmap_calc();
   }
 
-  if(has_replaced) {
+  if(num_replaced > 0) {
+    /* advertise the new sequence */
+    tsch_packet_invalidate_eb();
+    LOG_INFO("%u channel(s) replaced\n", num_replaced);
     last_time_changed = clock_seconds();
     return true;
   }
@@ -318,10 +315,11 @@ tsch_cs_channel_stats_updated(uint8_t updated_channel, uint16_t old_busyness_met
     /* the status of the channel has changed*/
     recaculation_requested = true;
 
-  } else if(new_is_busy) {
-    /* run the reselection algorithm iff the channel is both (1) bad and (2) in use */
-    if(tsch_cs_bitmap_contains(tsch_cs_current_bitmap, updated_channel)) {
-      /* the channel is in use and is busy */
+  } else if(tsch_cs_bitmap_contains(tsch_cs_current_bitmap, updated_channel)) {
+    /* run the reselection algorithm iff the channel is both (1) bad and (2) in use;
+     * bad means either busy, or with poor Tx success rate */
+    if(new_is_busy
+       || tsch_cs_channel_quality(index, tsch_cs_best_p_tx()) < TSCH_CS_FREE_THRESHOLD) {
       recaculation_requested = true;
     }
   }
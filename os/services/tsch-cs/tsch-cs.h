@@ -48,6 +48,16 @@
 #define TSCH_CS_FREE_THRESHOLD ((tsch_stat_t)(85ul * TSCH_STATS_BINARY_SCALING_FACTOR / 100))
 #endif
 
+/* The maximal number of channels replaced in a single adaptation. Nodes
+   switch to a new hopping sequence as soon as they hear it from their time
+   source, without coordination, so nodes that did not hear it yet lose
+   every replaced channel at once. */
+#ifdef TSCH_CS_CONF_MAX_CHANNELS_CHANGED
+#define TSCH_CS_MAX_CHANNELS_CHANGED TSCH_CS_CONF_MAX_CHANNELS_CHANGED
+#else
+#define TSCH_CS_MAX_CHANNELS_CHANGED 1
+#endif
+
 #define TSCH_CS_LEARNING_PERIOD_SEC 30
 
 /**
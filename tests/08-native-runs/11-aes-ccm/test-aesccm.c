@@ -32,6 +32,7 @@
 #include "lib/random.h"
 #include "unit-test.h"
 #include "lib/ccm-star.h"
+#include "lib/aes-128.h"
 #include "lib/hexconv.h"
 #include <string.h>
 #include <stdio.h>
@@ -166,6 +167,47 @@ UNIT_TEST(aesccm_decrypt)
   UNIT_TEST_END();
 }
 /*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(aes128_ttable, "AES-128 T-table driver");
+UNIT_TEST(aes128_ttable)
+{
+  int i;
+  int j;
+  uint8_t key_bytes[AES_128_KEY_LENGTH];
+  uint8_t block[AES_128_BLOCK_SIZE];
+  uint8_t expected[AES_128_BLOCK_SIZE];
+  /* FIPS-197, appendix C.1 */
+  static const char *fips_key = "000102030405060708090a0b0c0d0e0f";
+  static const char *fips_plaintext = "00112233445566778899aabbccddeeff";
+  static const char *fips_ciphertext = "69c4e0d86a7b0430d8cdb78070b4c55a";
+
+  UNIT_TEST_BEGIN();
+
+  printf("TEST: *** AES-128 T-table driver\n");
+
+  hexconv_unhexlify(fips_key, strlen(fips_key), key_bytes, sizeof(key_bytes));
+  hexconv_unhexlify(fips_plaintext, strlen(fips_plaintext), block, sizeof(block));
+  hexconv_unhexlify(fips_ciphertext, strlen(fips_ciphertext), expected, sizeof(expected));
+  aes_128_ttable_driver.set_key(key_bytes);
+  aes_128_ttable_driver.encrypt(block);
+  UNIT_TEST_ASSERT(!memcmp(block, expected, sizeof(block)));
+
+  /* Same output as the reference driver on random keys and blocks */
+  for(i = 0; i < 100; i++) {
+    for(j = 0; j < AES_128_KEY_LENGTH; j++) {
+      key_bytes[j] = random_rand();
+      block[j] = random_rand();
+    }
+    memcpy(expected, block, sizeof(block));
+    aes_128_driver.set_key(key_bytes);
+    aes_128_driver.encrypt(expected);
+    aes_128_ttable_driver.set_key(key_bytes);
+    aes_128_ttable_driver.encrypt(block);
+    UNIT_TEST_ASSERT(!memcmp(block, expected, sizeof(block)));
+  }
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
 PROCESS_THREAD(test_process, ev, data)
 {
   PROCESS_BEGIN();
@@ -175,6 +217,7 @@ PROCESS_THREAD(test_process, ev, data)
 
   UNIT_TEST_RUN(aesccm_encrypt);
   UNIT_TEST_RUN(aesccm_decrypt);
+  UNIT_TEST_RUN(aes128_ttable);
 
   printf("=check-me= DONE\n");
   printf("---\n");
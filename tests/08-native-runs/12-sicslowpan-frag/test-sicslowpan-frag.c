@@ -0,0 +1,329 @@
+/*
+ * Copyright (c) 2026, Vrije Universiteit Brussel.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ * 3. Neither the name of the Institute nor the names of its contributors
+ *    may be used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE INSTITUTE AND CONTRIBUTORS ``AS IS'' AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE INSTITUTE OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ * OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ * HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ * OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ * SUCH DAMAGE.
+ *
+ * This file is part of the Contiki operating system.
+ *
+ */
+
+/**
+ * \file
+ *         Regression tests for 6LoWPAN reassembly: fragments out of order,
+ *         duplicated fragments, and which contexts may be evicted when
+ *         they are all in use.
+ */
+
+#include "contiki.h"
+#include "net/ipv6/uip.h"
+#include "net/ipv6/uipbuf.h"
+#include "net/ipv6/sicslowpan.h"
+#include "net/packetbuf.h"
+#include "net/netstack.h"
+#include "net/mac/mac.h"
+#include "unit-test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+PROCESS(test_process, "6LoWPAN reassembly test");
+AUTOSTART_PROCESSES(&test_process);
+
+#define PAYLOAD_LEN 300
+#define MAX_FRAMES  8
+#define MAX_PACKETS 8
+
+struct frame {
+  uint8_t len;
+  uint8_t data[PACKETBUF_SIZE];
+};
+
+struct packet {
+  linkaddr_t sender;
+  uint8_t ip[UIP_IPH_LEN + PAYLOAD_LEN];
+  uint16_t ip_len;
+  struct frame frames[MAX_FRAMES];
+  uint8_t frame_count;
+  /* How many times the packet was passed up reassembled */
+  uint8_t delivered;
+};
+
+static struct packet packets[MAX_PACKETS];
+static struct packet *capturing;
+static int unexpected;
+
+/*---------------------------------------------------------------------------*/
+void
+print_test_report(const unit_test_t *utp)
+{
+  printf("=check-me= ");
+  if(utp->result == unit_test_failure) {
+    printf("FAILED   - %s: exit at L%u\n", utp->descr, utp->exit_line);
+  } else {
+    printf("SUCCEEDED - %s\n", utp->descr);
+  }
+}
+
+/*---------------------------------------------------------------------------*/
+/* A MAC that keeps the frames of the packet being fragmented */
+static void
+init(void)
+{
+}
+static void
+send(mac_callback_t sent, void *ptr)
+{
+  if(capturing != NULL && capturing->frame_count < MAX_FRAMES) {
+    struct frame *f = &capturing->frames[capturing->frame_count++];
+    f->len = packetbuf_datalen();
+    memcpy(f->data, packetbuf_dataptr(), f->len);
+  }
+  mac_call_sent_callback(sent, ptr, MAC_TX_OK, 1);
+}
+static void
+input(void)
+{
+}
+static int
+on(void)
+{
+  return 1;
+}
+static int
+off(void)
+{
+  return 1;
+}
+static int
+max_payload(void)
+{
+  return 90;
+}
+const struct mac_driver test_mac_driver = {
+  "test", init, send, input, on, off, max_payload
+};
+/*---------------------------------------------------------------------------*/
+/* Count the reassembled packets as 6LoWPAN passes them up */
+static void
+sniffer_input(void)
+{
+  int i;
+  for(i = 0; i < MAX_PACKETS; i++) {
+    if(packets[i].ip_len == uip_len
+       && !memcmp(packets[i].ip, uip_buf, uip_len)) {
+      packets[i].delivered++;
+      return;
+    }
+  }
+  unexpected++;
+}
+static void
+sniffer_output(int mac_status)
+{
+}
+NETSTACK_SNIFFER(test_sniffer, sniffer_input, sniffer_output);
+/*---------------------------------------------------------------------------*/
+/* Build a UDP packet from a sender of its own and fragment it */
+static struct packet *
+make_packet(uint8_t id)
+{
+  struct packet *p = &packets[id];
+  linkaddr_t dest;
+  int i;
+
+  memset(p, 0, sizeof(*p));
+  p->sender.u8[0] = 0x10;
+  p->sender.u8[LINKADDR_SIZE - 1] = id + 1;
+
+  memset(uip_buf, 0, UIP_IPH_LEN + UIP_UDPH_LEN);
+  UIP_IP_BUF->vtc = 0x60;
+  UIP_IP_BUF->proto = UIP_PROTO_UDP;
+  UIP_IP_BUF->ttl = 64;
+  uip_ip6addr(&UIP_IP_BUF->srcipaddr, 0xfd00, 0, 0, 0, 0x212, 0x7401, 1, id);
+  uip_ip6addr(&UIP_IP_BUF->destipaddr, 0xfd00, 0, 0, 0, 0x212, 0x7402, 2, 2);
+  uipbuf_set_len_field(UIP_IP_BUF, PAYLOAD_LEN);
+  UIP_UDP_BUF->srcport = UIP_HTONS(1000);
+  UIP_UDP_BUF->destport = UIP_HTONS(2000 + id);
+  UIP_UDP_BUF->udplen = UIP_HTONS(PAYLOAD_LEN);
+  for(i = UIP_UDPH_LEN; i < PAYLOAD_LEN; i++) {
+    uip_buf[UIP_IPH_LEN + i] = id + i;
+  }
+  uip_len = UIP_IPH_LEN + PAYLOAD_LEN;
+  uipbuf_clear_attr();
+  memcpy(p->ip, uip_buf, uip_len);
+  p->ip_len = uip_len;
+
+  linkaddr_copy(&dest, &linkaddr_node_addr);
+  capturing = p;
+  sicslowpan_driver.output(&dest);
+  capturing = NULL;
+  return p;
+}
+/*---------------------------------------------------------------------------*/
+/* Feed one of the frames of a packet to 6LoWPAN, as received from its
+   sender. The native network driver is tun6, 6LoWPAN is called directly. */
+static void
+receive(const struct packet *p, uint8_t frame)
+{
+  packetbuf_clear();
+  packetbuf_copyfrom(p->frames[frame].data, p->frames[frame].len);
+  packetbuf_set_addr(PACKETBUF_ADDR_SENDER, &p->sender);
+  packetbuf_set_addr(PACKETBUF_ADDR_RECEIVER, &linkaddr_node_addr);
+  sicslowpan_driver.input();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(out_of_order, "Fragments out of order");
+UNIT_TEST(out_of_order)
+{
+  struct packet *p;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  p = make_packet(0);
+  UNIT_TEST_ASSERT(p->frame_count >= 4);
+
+  /* Last fragment first, FRAG1 last */
+  for(i = p->frame_count - 1; i >= 0; i--) {
+    UNIT_TEST_ASSERT(p->delivered == 0);
+    receive(p, i);
+  }
+  UNIT_TEST_ASSERT(p->delivered == 1);
+  UNIT_TEST_ASSERT(unexpected == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(duplicates, "Duplicated fragments");
+UNIT_TEST(duplicates)
+{
+  struct packet *p;
+  uint16_t dup;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  p = make_packet(1);
+  UNIT_TEST_ASSERT(p->frame_count >= 4);
+  dup = uip_stat.reass.dup;
+
+  /* Every fragment twice, the second FRAGN before FRAG1 */
+  receive(p, 1);
+  for(i = 0; i < p->frame_count; i++) {
+    if(i != 1) {
+      receive(p, i);
+    }
+    receive(p, i);
+  }
+  UNIT_TEST_ASSERT(p->delivered == 1);
+  UNIT_TEST_ASSERT(uip_stat.reass.dup == dup + p->frame_count);
+
+  /* Late retransmissions of the whole packet */
+  for(i = 0; i < p->frame_count; i++) {
+    receive(p, i);
+  }
+  UNIT_TEST_ASSERT(p->delivered == 1);
+  UNIT_TEST_ASSERT(unexpected == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+UNIT_TEST_REGISTER(eviction, "Context eviction");
+UNIT_TEST(eviction)
+{
+  struct packet *a, *b, *c, *d, *e;
+  uint16_t drop, evicted;
+  int i;
+
+  UNIT_TEST_BEGIN();
+
+  a = make_packet(2);
+  b = make_packet(3);
+  c = make_packet(4);
+  d = make_packet(5);
+  e = make_packet(6);
+
+  /* Two reassemblies in progress take both contexts, replacing the
+     completed ones */
+  receive(a, 0);
+  receive(a, 1);
+  receive(b, 0);
+  receive(b, 1);
+
+  /* A lone FRAGN must not evict them */
+  drop = uip_stat.reass.drop;
+  evicted = uip_stat.reass.evicted;
+  receive(c, 2);
+  UNIT_TEST_ASSERT(uip_stat.reass.drop == drop + 1);
+  UNIT_TEST_ASSERT(uip_stat.reass.evicted == evicted);
+
+  for(i = 2; i < a->frame_count; i++) {
+    receive(a, i);
+  }
+  for(i = 2; i < b->frame_count; i++) {
+    receive(b, i);
+  }
+  UNIT_TEST_ASSERT(a->delivered == 1);
+  UNIT_TEST_ASSERT(b->delivered == 1);
+
+  /* Lone FRAGNs take the completed contexts, then evict each other */
+  receive(c, 2);
+  receive(d, 2);
+  UNIT_TEST_ASSERT(uip_stat.reass.evicted == evicted);
+  receive(c, 3);
+  UNIT_TEST_ASSERT(uip_stat.reass.evicted == evicted);
+  receive(e, 2);
+  UNIT_TEST_ASSERT(uip_stat.reass.evicted == evicted + 1);
+
+  /* A FRAG1 can evict a context opened by a lone FRAGN */
+  for(i = 0; i < d->frame_count; i++) {
+    receive(d, i);
+  }
+  UNIT_TEST_ASSERT(d->delivered == 1);
+  UNIT_TEST_ASSERT(unexpected == 0);
+
+  UNIT_TEST_END();
+}
+/*---------------------------------------------------------------------------*/
+PROCESS_THREAD(test_process, ev, data)
+{
+  PROCESS_BEGIN();
+
+  netstack_sniffer_add(&test_sniffer);
+
+  printf("Run unit-test\n");
+  printf("---\n");
+
+  UNIT_TEST_RUN(out_of_order);
+  UNIT_TEST_RUN(duplicates);
+  UNIT_TEST_RUN(eviction);
+
+  printf("=check-me= DONE\n");
+  printf("---\n");
+
+  PROCESS_END();
+}
+/*---------------------------------------------------------------------------*/